@@ -50,8 +50,11 @@ struct YTGraphDrawHelper {
 
     int x;
 
+    // y is the screen position of the min. value and yTop of the max. value
     int yPrev[2];
+    int yPrevTop[2];
     int y[2];
+    int yTop[2];
 
     Value::YtDataGetValueFunctionPointer ytDataGetValue;
 
@@ -70,24 +73,38 @@ struct YTGraphDrawHelper {
         ytDataGetValue = data::ytDataGetGetValueFunc(widgetCursor.cursor, widget->data);
     }
 
-    int getYValue(int valueIndex, uint32_t position) {
+    int getY(int valueIndex, float value) {
+        return widget->h - 1 - (int)round((widget->h - 1) * (value - min[valueIndex]) / (max[valueIndex] - min[valueIndex]));
+    }
+
+    // returns INT_MIN if value is not available or it is completely outside of the widget
+    int getYValue(int valueIndex, uint32_t position, int &yMax) {
         if (position >= numPositions) {
             return INT_MIN;
         }
 
-        float value = ytDataGetValue(position, valueIndex, nullptr);
+        float fMax = NAN;
+        float fMin = ytDataGetValue(position, valueIndex, &fMax);
 
-        if (isNaN(value)) {
+        if (isNaN(fMin)) {
             return INT_MIN;
         }
 
-        int y = (int)round((widget->h - 1) * (value - min[valueIndex]) / (max[valueIndex] - min[valueIndex]));
+        int y = getY(valueIndex, fMin);
+        yMax = isNaN(fMax) ? y : getY(valueIndex, fMax);
 
-        if (y < 0 || y >= widget->h) {
+        if (yMax >= widget->h || y < 0) {
             return INT_MIN;
         }
 
-        return widget->h - 1 - y;
+        if (yMax < 0) {
+            yMax = 0;
+        }
+        if (y >= widget->h) {
+            y = widget->h - 1;
+        }
+
+        return y;
     }
 
     void drawValue(int valueIndex) {
@@ -97,19 +114,26 @@ struct YTGraphDrawHelper {
 
         display::setColor16(dataColor16[valueIndex]);
 
-        if (yPrev[valueIndex] == INT_MIN || abs(yPrev[valueIndex] - y[valueIndex]) <= 1) {
-            display::drawPixel(x, widgetCursor.y + y[valueIndex]);
-        } else {
-            if (yPrev[valueIndex] < y[valueIndex]) {
-                display::drawVLine(x, widgetCursor.y + yPrev[valueIndex] + 1, y[valueIndex] - yPrev[valueIndex] - 1);
-            } else {
-                display::drawVLine(x, widgetCursor.y + y[valueIndex], yPrev[valueIndex] - y[valueIndex] - 1);
+        // draw the envelope of the point connected to the previous point
+        int yFrom = yTop[valueIndex];
+        int yTo = y[valueIndex];
+        if (yPrev[valueIndex] != INT_MIN) {
+            if (yPrev[valueIndex] < yFrom - 1) {
+                yFrom = yPrev[valueIndex] + 1;
+            } else if (yPrevTop[valueIndex] > yTo + 1) {
+                yTo = yPrevTop[valueIndex] - 1;
             }
         }
+
+        if (yFrom == yTo) {
+            display::drawPixel(x, widgetCursor.y + yFrom);
+        } else {
+            display::drawVLine(x, widgetCursor.y + yFrom, yTo - yFrom);
+        }
     }
 
     void drawStep() {
-        if (y[0] != INT_MIN && y[1] != INT_MIN && abs(yPrev[0] - y[0]) <= 1 && abs(yPrev[1] - y[1]) <= 1 && y[0] == y[1]) {
+        if (y[0] != INT_MIN && y[1] != INT_MIN && y[0] == yTop[0] && y[1] == yTop[1] && abs(yPrev[0] - y[0]) <= 1 && abs(yPrev[1] - y[1]) <= 1 && y[0] == y[1]) {
             display::setColor16(position % 2 ? dataColor16[1] : dataColor16[0]);
             display::drawPixel(x, widgetCursor.y + y[0]);
         } else {
@@ -134,11 +158,11 @@ struct YTGraphDrawHelper {
         for (position = startPosition; position < endPosition; ++position) {
             x = widgetCursor.x + position % graphWidth;
 
-            y[0] = getYValue(0, position);
-            yPrev[0] = getYValue(0, position == 0 ? position : position - 1);
+            y[0] = getYValue(0, position, yTop[0]);
+            yPrev[0] = getYValue(0, position == 0 ? position : position - 1, yPrevTop[0]);
 
-            y[1] = getYValue(1, position);
-            yPrev[1] = getYValue(1, position == 0 ? position : position - 1);
+            y[1] = getYValue(1, position, yTop[1]);
+            yPrev[1] = getYValue(1, position == 0 ? position : position - 1, yPrevTop[1]);
 
             drawStep();
         }
@@ -167,20 +191,22 @@ struct YTGraphDrawHelper {
 
         numPositions = position + numPointsToDraw;
 
-        yPrev[0] = getYValue(0, previousHistoryValuePosition);
-        yPrev[1] = getYValue(1, previousHistoryValuePosition);
+        yPrev[0] = getYValue(0, previousHistoryValuePosition, yPrevTop[0]);
+        yPrev[1] = getYValue(1, previousHistoryValuePosition, yPrevTop[1]);
 
         display::setColor16(color16);
         display::fillRect(startX, widgetCursor.y, endX - 1, widgetCursor.y + widget->h - 1);
 
         for (x = startX; x < endX; x++, position++) {
-            y[0] = getYValue(0, position);
-            y[1] = getYValue(1, position);
+            y[0] = getYValue(0, position, yTop[0]);
+            y[1] = getYValue(1, position, yTop[1]);
 
             drawStep();
 
             yPrev[0] = y[0];
+            yPrevTop[0] = yTop[0];
             yPrev[1] = y[1];
+            yPrevTop[1] = yTop[1];
         }
     }
 };
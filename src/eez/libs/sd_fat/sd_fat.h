@@ -166,4 +166,9 @@ class SdFat {
 
 char *getConfFilePath(const char *file_name);
 
+#ifdef EEZ_PLATFORM_SIMULATOR
+// path of the file, inside the simulator SD card folder, on the host file system
+std::string getRealPath(const char *path);
+#endif
+
 } // namespace eez
@@ -42,7 +42,10 @@ static const uint32_t DECOMPRESSED_ASSETS_SIZE = 4 * 1024 * 1024;
 static uint8_t * const DLOG_RECORD_BUFFER = DECOMPRESSED_ASSETS_START_ADDRESS + DECOMPRESSED_ASSETS_SIZE;
 static const uint32_t DLOG_RECORD_BUFFER_SIZE = 128 * 1024;
 
-static uint8_t * const FILE_VIEW_BUFFER = DLOG_RECORD_BUFFER + DLOG_RECORD_BUFFER_SIZE;
+static uint8_t * const DLOG_BLOCK_BUFFER = DLOG_RECORD_BUFFER + DLOG_RECORD_BUFFER_SIZE;
+static const uint32_t DLOG_BLOCK_BUFFER_SIZE = 4 * 1024;
+
+static uint8_t * const FILE_VIEW_BUFFER = DLOG_BLOCK_BUFFER + DLOG_BLOCK_BUFFER_SIZE;
 static const uint32_t FILE_VIEW_BUFFER_SIZE = (3 * 512 - 128) * 1024;
 
 static uint8_t * const MP_BUFFER = FILE_VIEW_BUFFER + FILE_VIEW_BUFFER_SIZE;
@@ -60,7 +63,16 @@ static const uint32_t VRAM_SCREENSHOOT_JPEG_OUT_BUFFER_SIZE = 256 * 1024;
 static uint8_t * const DEBUG_TRACE_LOG = VRAM_SCREENSHOOT_JPEG_OUT_BUFFER + VRAM_SCREENSHOOT_JPEG_OUT_BUFFER_SIZE;
 static const uint32_t DEBUG_TRACE_LOG_SIZE = 32 * 1024;
 
-static uint8_t * const SCREENSHOOT_BUFFER_START_ADDRESS = DEBUG_TRACE_LOG + DEBUG_TRACE_LOG_SIZE;
+static uint8_t * const CHANNEL_HISTORY_BUFFER = DEBUG_TRACE_LOG + DEBUG_TRACE_LOG_SIZE;
+static const uint32_t CHANNEL_HISTORY_BUFFER_SIZE = 6 * 68 * 1024;
+
+static uint8_t * const LIST_STEPS_BUFFER = CHANNEL_HISTORY_BUFFER + CHANNEL_HISTORY_BUFFER_SIZE;
+static const uint32_t LIST_STEPS_BUFFER_SIZE = 6 * 256 * 16;
+
+static uint8_t * const LIST_STREAM_BUFFER = LIST_STEPS_BUFFER + LIST_STEPS_BUFFER_SIZE;
+static const uint32_t LIST_STREAM_BUFFER_SIZE = 6 * 1024 * 24;
+
+static uint8_t * const SCREENSHOOT_BUFFER_START_ADDRESS = LIST_STREAM_BUFFER + LIST_STREAM_BUFFER_SIZE;
 static const uint32_t SCREENSHOOT_BUFFER_SIZE = 480 * 272 * 3;
 
 #if defined(EEZ_PLATFORM_STM32)
@@ -92,3 +104,14 @@ static uint8_t * const VRAM_AUX_BUFFER7_START_ADDRESS = VRAM_AUX_BUFFER6_START_A
 static uint8_t * const VRAM_AUX_BUFFER8_START_ADDRESS = VRAM_AUX_BUFFER7_START_ADDRESS + VRAM_BUFFER_SIZE;
 
 static uint8_t * const MEMORY_END = VRAM_AUX_BUFFER8_START_ADDRESS + VRAM_BUFFER_SIZE;
+
+#if defined(EEZ_PLATFORM_STM32)
+// MEMORY_END <= MEMORY_BEGIN + MEMORY_SIZE, addresses are not constant expressions so sizes are added up
+static_assert(
+    DECOMPRESSED_ASSETS_SIZE + DLOG_RECORD_BUFFER_SIZE + DLOG_BLOCK_BUFFER_SIZE + FILE_VIEW_BUFFER_SIZE +
+    MP_BUFFER_SIZE + SOUND_TUNES_MEMORY_SIZE + FILE_MANAGER_MEMORY_SIZE + VRAM_SCREENSHOOT_JPEG_OUT_BUFFER_SIZE +
+    DEBUG_TRACE_LOG_SIZE + CHANNEL_HISTORY_BUFFER_SIZE + LIST_STEPS_BUFFER_SIZE + LIST_STREAM_BUFFER_SIZE +
+    SCREENSHOOT_BUFFER_SIZE + 12 * VRAM_BUFFER_SIZE <= MEMORY_SIZE,
+    "SDRAM buffers don't fit in MEMORY_SIZE"
+);
+#endif
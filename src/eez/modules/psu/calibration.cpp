@@ -451,6 +451,8 @@ bool save() {
         }
     }
 
+    g_channel->updateCalibrationCoefficients();
+
     resetChannelToZero();
 
     // TODO move this to scpi thread
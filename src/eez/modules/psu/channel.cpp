@@ -66,66 +66,74 @@ void Channel::Value::resetMonValues() {
     mon_last = 0;
     mon_dac = 0;
 
-    mon_index = -1;
-    mon_dac_index = -1;
+    mon_avg.numValues = 0;
+    mon_dac_avg.numValues = 0;
 
     mon_measured = false;
 }
 
-void Channel::Value::addMonValue(float value, float prec) {
+void Channel::MovingAverage::init(float value, uint8_t numValues_) {
+    numValues = numValues_;
+    index = 0;
+    for (int i = 0; i < numValues; ++i) {
+        values[i] = value;
+    }
+    total = numValues * value;
+}
+
+float Channel::MovingAverage::add(float value) {
+    total -= values[index];
+    total += value;
+    values[index] = value;
+
+    if (++index == numValues) {
+        index = 0;
+
+        // once per window, to remove rounding errors of the running sum
+        total = 0;
+        for (int i = 0; i < numValues; ++i) {
+            total += values[i];
+        }
+    }
+
+    return total / numValues;
+}
+
+void Channel::Value::addMonValue(float value, float prec, uint8_t numAveragingValues) {
     if (io_pins::isInhibited()) {
         value = 0;
     }
     
     mon_last = roundPrec(value, prec);
 
-    if (mon_index == -1) {
-        mon_index = 0;
-        for (int i = 0; i < NUM_ADC_AVERAGING_VALUES; ++i) {
-            mon_arr[i] = value;
-        }
-        mon_total = NUM_ADC_AVERAGING_VALUES * value;
+    if (mon_avg.numValues != numAveragingValues) {
+        mon_avg.init(value, numAveragingValues);
         mon = mon_last;
         mon_prev = mon_last;
     } else {
-        mon_total -= mon_arr[mon_index];
-        mon_total += value;
-        mon_arr[mon_index] = value;
-        mon_index = (mon_index + 1) % NUM_ADC_AVERAGING_VALUES;
+        float mon_next = mon_avg.add(value);
 
         if (io_pins::isInhibited()) {
             mon = 0;
             mon_prev = 0;
-        } else {
-            float mon_next = mon_total / NUM_ADC_AVERAGING_VALUES;
-            if (fabs(mon_prev - mon_next) >= prec) {
-                mon = roundPrec(mon_next, prec);
-                mon_prev = mon_next;
-            }
+        } else if (fabs(mon_prev - mon_next) >= prec) {
+            mon = roundPrec(mon_next, prec);
+            mon_prev = mon_next;
         }
     }
 
     mon_measured = true;
 }
 
-void Channel::Value::addMonDacValue(float value, float prec) {
+void Channel::Value::addMonDacValue(float value, float prec, uint8_t numAveragingValues) {
     mon_dac_last = roundPrec(value, prec);
 
-    if (mon_dac_index == -1) {
-        mon_dac_index = 0;
-        for (int i = 0; i < NUM_ADC_AVERAGING_VALUES; ++i) {
-            mon_dac_arr[i] = value;
-        }
-        mon_dac_total = NUM_ADC_AVERAGING_VALUES * value;
+    if (mon_dac_avg.numValues != numAveragingValues) {
+        mon_dac_avg.init(value, numAveragingValues);
         mon_dac = mon_dac_last;
         mon_dac_prev = mon_dac_last;
     } else {
-        mon_dac_total -= mon_dac_arr[mon_dac_index];
-        mon_dac_total += value;
-        mon_dac_arr[mon_dac_index] = value;
-        mon_dac_index = (mon_dac_index + 1) % NUM_ADC_AVERAGING_VALUES;
-
-        float mon_dac_next = mon_dac_total / NUM_ADC_AVERAGING_VALUES;
+        float mon_dac_next = mon_dac_avg.add(value);
 
 		if (fabs(mon_dac_prev - mon_dac_next) >= prec) {
 			mon_dac = roundPrec(mon_dac_next, prec);
@@ -174,163 +182,49 @@ void Channel::restoreOE() {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-float Channel::getChannel0HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    Channel &channel = g_channels[0];
-
-    uint32_t position = rowIndex % CHANNEL_HISTORY_SIZE;
-    
-    if (columnIndex == 0) {
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    } else {
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    }
-
-    return channel.uHistory[position] * channel.iHistory[position];
-}
+// Returns min. value of the point and max. value in *max
+template <int CHANNEL_INDEX>
+float Channel::getChannelHistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
+    Channel &channel = g_channels[CHANNEL_INDEX];
 
-float Channel::getChannel1HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    Channel &channel = g_channels[1];
+    int displayValue = columnIndex == 0 ? channel.flags.displayValue1 : channel.flags.displayValue2;
 
-    uint32_t position = rowIndex % CHANNEL_HISTORY_SIZE;
-
-    if (columnIndex == 0) {
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
+    ChannelHistory::ValueType valueType;
+    if (displayValue == DISPLAY_VALUE_VOLTAGE) {
+        valueType = ChannelHistory::VALUE_TYPE_U;
+    } else if (displayValue == DISPLAY_VALUE_CURRENT) {
+        valueType = ChannelHistory::VALUE_TYPE_I;
     } else {
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
+        valueType = ChannelHistory::VALUE_TYPE_P;
     }
 
-    return channel.uHistory[position] * channel.iHistory[position];
-}
-
-float Channel::getChannel2HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    Channel &channel = g_channels[2];
-
-    uint32_t position = rowIndex % CHANNEL_HISTORY_SIZE;
-
-    if (columnIndex == 0) {
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    } else {
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
+    float min;
+    float fMax;
+    if (!channel.history.getPoint(rowIndex, (uint32_t)roundf(channel.ytViewRate * 1000000), valueType, min, fMax)) {
+        min = NAN;
+        fMax = NAN;
     }
 
-    return channel.uHistory[position] * channel.iHistory[position];
-}
-
-float Channel::getChannel3HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    Channel &channel = g_channels[3];
-
-    uint32_t position = rowIndex % CHANNEL_HISTORY_SIZE;
-
-    if (columnIndex == 0) {
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    } else {
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
+    if (max) {
+        *max = fMax;
     }
 
-    return channel.uHistory[position] * channel.iHistory[position];
-}
-
-float Channel::getChannel4HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    Channel &channel = g_channels[4];
-
-    uint32_t position = rowIndex % CHANNEL_HISTORY_SIZE;
-
-    if (columnIndex == 0) {
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    } else {
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    }
-
-    return channel.uHistory[position] * channel.iHistory[position];
-}
-
-float Channel::getChannel5HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    Channel &channel = g_channels[5];
-
-    uint32_t position = rowIndex % CHANNEL_HISTORY_SIZE;
-
-    if (columnIndex == 0) {
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-        if (channel.flags.displayValue1 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-    } else {
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_CURRENT) {
-            return channel.iHistory[position];
-        }
-        if (channel.flags.displayValue2 == DISPLAY_VALUE_VOLTAGE) {
-            return channel.uHistory[position];
-        }
-    }
-
-    return channel.uHistory[position] * channel.iHistory[position];
+    return min;
 }
 
 Channel::YtDataGetValueFunctionPointer Channel::getChannelHistoryValueFuncs(int channelIndex) {
     if (channelIndex == 0) {
-        return Channel::getChannel0HistoryValue;
+        return Channel::getChannelHistoryValue<0>;
     } else if (channelIndex == 1) {
-        return Channel::getChannel1HistoryValue;
+        return Channel::getChannelHistoryValue<1>;
     } else if (channelIndex == 2) {
-        return Channel::getChannel2HistoryValue;
+        return Channel::getChannelHistoryValue<2>;
     } else if (channelIndex == 3) {
-        return Channel::getChannel3HistoryValue;
+        return Channel::getChannelHistoryValue<3>;
     } else if (channelIndex == 4) {
-        return Channel::getChannel4HistoryValue;
+        return Channel::getChannelHistoryValue<4>;
     } else {
-        return Channel::getChannel5HistoryValue;
+        return Channel::getChannelHistoryValue<5>;
     }
 }
 
@@ -400,11 +294,14 @@ void Channel::set(uint8_t slotIndex_, uint8_t subchannelIndex_) {
     flags.displayValue1 = DISPLAY_VALUE_VOLTAGE;
     flags.displayValue2 = DISPLAY_VALUE_CURRENT;
     ytViewRate = GUI_YT_VIEW_RATE_DEFAULT;
+    adcAveragingNumValues = NUM_ADC_AVERAGING_VALUES;
 
     autoRangeCheckLastTickCount = 0;
 
     flags.cvMode = 0;
     flags.ccMode = 0;
+
+    updateCalibrationCoefficients();
 }
 
 void Channel::setChannelIndex(uint8_t channelIndex_) {
@@ -459,60 +356,20 @@ bool Channel::checkSwOvpCondition(float uProtectionLevel) {
     return channel_dispatcher::getUMonLast(*this) >= uProtectionLevel || (flags.rprogEnabled && channel_dispatcher::getUMonDacLast(*this) >= uProtectionLevel);
 }
 
-void Channel::protectionCheck(ProtectionValue &cpv) {
-    bool state;
-    bool condition;
-    float delay;
-
-    if (IS_OVP_VALUE(this, cpv)) {
-        state = (flags.rprogEnabled || prot_conf.flags.u_state) && !((params.features & CH_FEATURE_HW_OVP) && prot_conf.flags.u_type);
-        condition = checkSwOvpCondition(channel_dispatcher::getUProtectionLevel(*this));
-        delay = prot_conf.u_delay;
-        delay -= PROT_DELAY_CORRECTION;
-    } else if (IS_OCP_VALUE(this, cpv)) {
-        state = prot_conf.flags.i_state;
-        condition = channel_dispatcher::getIMonLast(*this) >= channel_dispatcher::getISet(*this);
-        delay = prot_conf.i_delay;
-        delay -= PROT_DELAY_CORRECTION;
-    } else {
-        state = prot_conf.flags.p_state;
-        condition = channel_dispatcher::getUMonLast(*this) * channel_dispatcher::getIMonLast(*this) > channel_dispatcher::getPowerProtectionLevel(*this);
-        delay = prot_conf.p_delay;
-    }
-
+void Channel::protectionCheck(ProtectionValue &cpv, bool state, bool condition, float delay, uint32_t tickCount) {
+    // output is disabled if some previously checked protection is tripped
     if (state && isOutputEnabled() && condition) {
         if (delay > 0) {
             if (cpv.flags.alarmed) {
-                if (micros() - cpv.alarm_started >= delay * 1000000UL) {
+                if (tickCount - cpv.alarm_started >= delay * 1000000UL) {
                     cpv.flags.alarmed = 0;
-
-                    // if (IS_OVP_VALUE(this, cpv)) {
-                    //    DebugTrace("OVP condition: CV_MODE=%d, CC_MODE=%d, I DIFF=%d mA, I MON=%d
-                    //    mA", (int)flags.cvMode, (int)flags.ccMode, (int)(fabs(i.mon_last - i.set)
-                    //    * 1000), (int)(i.mon_last * 1000));
-                    //}
-                    // else if (IS_OCP_VALUE(this, cpv)) {
-                    //    DebugTrace("OCP condition: CC_MODE=%d, CV_MODE=%d, U DIFF=%d mV",
-                    //    (int)flags.ccMode, (int)flags.cvMode, (int)(fabs(u.mon_last - u.set) *
-                    //    1000));
-                    //}
-
                     protectionEnter(cpv);
                 }
             } else {
                 cpv.flags.alarmed = 1;
-                cpv.alarm_started = micros();
+                cpv.alarm_started = tickCount;
             }
         } else {
-            // if (IS_OVP_VALUE(this, cpv)) {
-            //    DebugTrace("OVP condition: CV_MODE=%d, CC_MODE=%d, I DIFF=%d mA",
-            //    (int)flags.cvMode, (int)flags.ccMode, (int)(fabs(i.mon_last - i.set) * 1000));
-            //}
-            // else if (IS_OCP_VALUE(this, cpv)) {
-            //    DebugTrace("OCP condition: CC_MODE=%d, CV_MODE=%d, U DIFF=%d mV",
-            //    (int)flags.ccMode, (int)flags.cvMode, (int)(fabs(u.mon_last - u.set) * 1000));
-            //}
-
             protectionEnter(cpv);
         }
     } else {
@@ -520,6 +377,31 @@ void Channel::protectionCheck(ProtectionValue &cpv) {
     }
 }
 
+void Channel::protectionCheck() {
+    uint32_t tickCount = micros();
+
+    float uMonLast = channel_dispatcher::getUMonLast(*this);
+    float iMonLast = channel_dispatcher::getIMonLast(*this);
+
+    protectionCheck(ovp,
+        (flags.rprogEnabled || prot_conf.flags.u_state) && !((params.features & CH_FEATURE_HW_OVP) && prot_conf.flags.u_type),
+        checkSwOvpCondition(channel_dispatcher::getUProtectionLevel(*this)),
+        prot_conf.u_delay - PROT_DELAY_CORRECTION,
+        tickCount);
+
+    protectionCheck(ocp,
+        prot_conf.flags.i_state,
+        iMonLast >= channel_dispatcher::getISet(*this),
+        prot_conf.i_delay - PROT_DELAY_CORRECTION,
+        tickCount);
+
+    protectionCheck(opp,
+        prot_conf.flags.p_state,
+        uMonLast * iMonLast > channel_dispatcher::getPowerProtectionLevel(*this),
+        prot_conf.p_delay,
+        tickCount);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void Channel::init() {
@@ -527,6 +409,7 @@ void Channel::init() {
         return;
     }
     channelInterface->init(subchannelIndex);
+    resetHistory();
 }
 
 void Channel::onPowerDown() {
@@ -609,6 +492,7 @@ void Channel::reset() {
     flags.displayValue1 = DISPLAY_VALUE_VOLTAGE;
     flags.displayValue2 = DISPLAY_VALUE_CURRENT;
     ytViewRate = GUI_YT_VIEW_RATE_DEFAULT;
+    adcAveragingNumValues = NUM_ADC_AVERAGING_VALUES;
 
     flags.voltageTriggerMode = TRIGGER_MODE_FIXED;
     flags.currentTriggerMode = TRIGGER_MODE_FIXED;
@@ -627,16 +511,18 @@ void Channel::reset() {
 }
 
 uint32_t Channel::getCurrentHistoryValuePosition() {
-	return historyPosition;
+    uint32_t numPoints = history.getNumPoints((uint32_t)roundf(ytViewRate * 1000000));
+    return numPoints > 0 ? numPoints : 1;
+}
+
+uint32_t Channel::getHistoryRefreshCounter() {
+    // all the points are different when view rate is changed
+    return (uint32_t)roundf(ytViewRate * 1000000);
 }
 
 void Channel::resetHistory() {
-    for (int i = 0; i < CHANNEL_HISTORY_SIZE; ++i) {
-        uHistory[i] = 0;
-        iHistory[i] = 0;
-    }
+    history.reset(channelIndex);
     flags.historyStarted = 0;
-    historyPosition = 1;
 }
 
 void Channel::clearCalibrationConf() {
@@ -664,6 +550,30 @@ void Channel::clearCalibrationConf() {
 
     strcpy(cal_conf.calibration_date, "");
     strcpy(cal_conf.calibration_remark, CALIBRATION_REMARK_INIT);
+
+    updateCalibrationCoefficients();
+}
+
+void Channel::updateCalibrationCoefficients() {
+    if (flags._calEnabled && cal_conf.flags.u_cal_params_exists) {
+        uDacCalibration.init(cal_conf.u.min.val, cal_conf.u.min.dac, cal_conf.u.max.val, cal_conf.u.max.dac);
+        uAdcCalibration.init(cal_conf.u.min.adc, cal_conf.u.min.val, cal_conf.u.max.adc, cal_conf.u.max.val);
+    } else {
+        uDacCalibration.initIdentity();
+        uAdcCalibration.initIdentity();
+    }
+
+    for (int range = 0; range < 2; range++) {
+        bool exists = range == CURRENT_RANGE_HIGH ? cal_conf.flags.i_cal_params_exists_range_high : cal_conf.flags.i_cal_params_exists_range_low;
+        if (flags._calEnabled && exists) {
+            CalibrationValueConfiguration &i = cal_conf.i[range];
+            iDacCalibration[range].init(i.min.val, i.min.dac, i.max.val, i.max.dac);
+            iAdcCalibration[range].init(i.min.adc, i.min.val, i.max.adc, i.max.val);
+        } else {
+            iDacCalibration[range].initIdentity();
+            iAdcCalibration[range].initIdentity();
+        }
+    }
 }
 
 void Channel::clearProtectionConf() {
@@ -762,15 +672,10 @@ void Channel::tick(uint32_t tick_usec) {
     if (!flags.historyStarted) {
         flags.historyStarted = 1;
         historyLastTick = tick_usec;
-        historyPosition = 1;
     } else {
-        uint32_t ytViewRateMicroseconds = (int)round(ytViewRate * 1000000L);
-        while (tick_usec - historyLastTick >= ytViewRateMicroseconds) {
-            uint32_t historyIndex = historyPosition % CHANNEL_HISTORY_SIZE;
-            uHistory[historyIndex] = channel_dispatcher::getUMonLast(*this);
-            iHistory[historyIndex] = channel_dispatcher::getIMonLast(*this);
-            historyPosition++;
-            historyLastTick += ytViewRateMicroseconds;
+        while (tick_usec - historyLastTick >= ChannelHistory::BASE_PERIOD) {
+            history.addValue(channel_dispatcher::getUMonLast(*this), channel_dispatcher::getIMonLast(*this));
+            historyLastTick += ChannelHistory::BASE_PERIOD;
         }
     }
 
@@ -835,29 +740,23 @@ float Channel::roundChannelValue(Unit unit, float value) const {
 }
 
 void Channel::addUMonAdcValue(float value) {
-    if (isVoltageCalibrationEnabled()) {
-        value = remap(value, cal_conf.u.min.adc, cal_conf.u.min.val, cal_conf.u.max.adc, cal_conf.u.max.val);
-    }
+    value = calibrateAdcVoltage(value);
 
-    u.addMonValue(value, getVoltageResolution());
+    u.addMonValue(value, getVoltageResolution(), adcAveragingNumValues);
 }
 
 void Channel::addIMonAdcValue(float value) {
-    if (isCurrentCalibrationEnabled()) {
-        value = remap(value,
-            cal_conf.i[flags.currentCurrentRange].min.adc, cal_conf.i[flags.currentCurrentRange].min.val,
-            cal_conf.i[flags.currentCurrentRange].max.adc, cal_conf.i[flags.currentCurrentRange].max.val);
-    }
+    value = calibrateAdcCurrent(value);
 
-    i.addMonValue(value, getCurrentResolution());
+    i.addMonValue(value, getCurrentResolution(), adcAveragingNumValues);
 }
 
 void Channel::addUMonDacAdcValue(float value) {
-    u.addMonDacValue(value, getVoltageResolution());
+    u.addMonDacValue(value, getVoltageResolution(), adcAveragingNumValues);
 }
 
 void Channel::addIMonDacAdcValue(float value) {
-    i.addMonDacValue(value, getCurrentResolution());
+    i.addMonDacValue(value, getCurrentResolution(), adcAveragingNumValues);
 }
 
 void Channel::onAdcData(AdcDataType adcDataType, float value) {
@@ -900,12 +799,6 @@ void Channel::setCvMode(bool cv_mode) {
     }
 }
 
-void Channel::protectionCheck() {
-    protectionCheck(ovp);
-    protectionCheck(ocp);
-    protectionCheck(opp);
-}
-
 void Channel::adcMeasureMonDac() {
     channelInterface->adcMeasureMonDac(subchannelIndex);
 }
@@ -1136,6 +1029,7 @@ bool Channel::isOutputEnabled() {
 
 void Channel::doCalibrationEnable(bool enable) {
     flags._calEnabled = enable;
+    updateCalibrationCoefficients();
 
     if (enable) {
         u.min = roundChannelValue(UNIT_VOLT, MAX(cal_conf.u.minPossible, params.U_MIN));
@@ -1198,17 +1092,6 @@ bool Channel::isCalibrationEnabled() {
     return flags._calEnabled;
 }
 
-bool Channel::isVoltageCalibrationEnabled() {
-    return flags._calEnabled && cal_conf.flags.u_cal_params_exists;
-}
-
-bool Channel::isCurrentCalibrationEnabled() {
-    return flags._calEnabled && ((flags.currentCurrentRange == CURRENT_RANGE_HIGH &&
-                                  cal_conf.flags.i_cal_params_exists_range_high) ||
-                                 (flags.currentCurrentRange == CURRENT_RANGE_LOW &&
-                                  cal_conf.flags.i_cal_params_exists_range_low));
-}
-
 void Channel::remoteSensingEnable(bool enable) {
     if (enable != flags.senseEnabled) {
         doRemoteSensingEnable(enable);
@@ -1235,9 +1118,7 @@ bool Channel::isRemoteProgrammingEnabled() {
 }
 
 float Channel::getCalibratedVoltage(float value) {
-    if (isVoltageCalibrationEnabled()) {
-        value = remap(value, cal_conf.u.min.val, cal_conf.u.min.dac, cal_conf.u.max.val, cal_conf.u.max.dac);
-    }
+    value = calibrateDacVoltage(value);
 
 #if !defined(EEZ_PLATFORM_SIMULATOR)
     value += params.VOLTAGE_GND_OFFSET;
@@ -1281,12 +1162,7 @@ void Channel::doSetCurrent(float value) {
     i.set = value;
     i.mon_dac = 0;
 
-    if (isCurrentCalibrationEnabled()) {
-        value = remap(value, cal_conf.i[flags.currentCurrentRange].min.val,
-                      cal_conf.i[flags.currentCurrentRange].min.dac,
-                      cal_conf.i[flags.currentCurrentRange].max.val,
-                      cal_conf.i[flags.currentCurrentRange].max.dac);
-    }
+    value = calibrateDacCurrent(value);
 
     value += getDualRangeGndOffset();
 
@@ -21,6 +21,7 @@
 #include <math.h>
 
 #include <eez/modules/psu/persist_conf.h>
+#include <eez/modules/psu/channel_history.h>
 #include <eez/modules/psu/temp_sensor.h>
 
 #define IS_OVP_VALUE(channel, cpv) (&cpv == &channel->ovp)
@@ -128,6 +129,27 @@ class Channel {
         float maxPossible;
     };
 
+    /// Linear calibration `y = scale * x + offset`, precomputed from the `min` and `max` points,
+    /// so calibrating DAC and ADC values is only multiply-add.
+    struct LinearCalibration {
+        float scale;
+        float offset;
+
+        void init(float x1, float y1, float x2, float y2) {
+            scale = (y2 - y1) / (x2 - x1);
+            offset = y1 - x1 * scale;
+        }
+
+        void initIdentity() {
+            scale = 1.0f;
+            offset = 0;
+        }
+
+        inline float apply(float x) const {
+            return scale * x + offset;
+        }
+    };
+
     /// A structure where calibration parameters for the channel are stored.
     struct CalibrationConfiguration {
         /// Used by the persist_conf.
@@ -203,6 +225,18 @@ class Channel {
         unsigned dprogState: 2;
     };
 
+    /// Moving average of the last numValues ADC values. Sum is updated with every value and
+    /// recalculated from the values once per window, so float rounding errors don't accumulate.
+    struct MovingAverage {
+        float values[NUM_ADC_AVERAGING_VALUES_MAX];
+        float total;
+        uint8_t numValues; // 0 if there are no values yet
+        uint8_t index;
+
+        void init(float value, uint8_t numValues);
+        float add(float value);
+    };
+
     /// Voltage and current data set and measured during runtime.
     struct Value {
         float set;
@@ -214,16 +248,12 @@ class Channel {
         float mon;
         float mon_prev;
         float mon_last;
-        int8_t mon_index;
-        float mon_arr[NUM_ADC_AVERAGING_VALUES];
-        float mon_total;
+        MovingAverage mon_avg;
 
         float mon_dac;
         float mon_dac_prev;
         float mon_dac_last;
-        int8_t mon_dac_index;
-        float mon_dac_arr[NUM_ADC_AVERAGING_VALUES];
-        float mon_dac_total;
+        MovingAverage mon_dac_avg;
 
         float step;
         float limit;
@@ -234,8 +264,8 @@ class Channel {
 
         void init(float set_, float step_, float limit_);
         void resetMonValues();
-        void addMonDacValue(float value, float precision);
-        void addMonValue(float value, float precision);
+        void addMonDacValue(float value, float precision, uint8_t numAveragingValues);
+        void addMonValue(float value, float precision, uint8_t numAveragingValues);
     };
 
 #ifdef EEZ_PLATFORM_SIMULATOR
@@ -314,6 +344,10 @@ class Channel {
 
     float ytViewRate;
 
+    /// Number of ADC values averaged for u.mon, i.mon, u.mon_dac and i.mon_dac.
+    /// When changed, averaging is restarted with the next ADC value.
+    uint8_t adcAveragingNumValues;
+
 #ifdef EEZ_PLATFORM_SIMULATOR
     Simulator simulator;
 #endif // EEZ_PLATFORM_SIMULATOR
@@ -332,6 +366,9 @@ class Channel {
     /// Clear channel calibration configuration.
     void clearCalibrationConf();
 
+    /// Precompute calibration coefficients, must be called when cal_conf is changed.
+    void updateCalibrationCoefficients();
+
     /// Test the channel.
     bool test();
 
@@ -399,6 +436,24 @@ class Channel {
 
     float getCalibratedVoltage(float value);
 
+    /// Set value to DAC value, identity if calibration is not enabled.
+    inline float calibrateDacVoltage(float value) {
+        return uDacCalibration.apply(value);
+    }
+
+    inline float calibrateDacCurrent(float value) {
+        return iDacCalibration[flags.currentCurrentRange].apply(value);
+    }
+
+    /// ADC value to measured value, identity if calibration is not enabled.
+    inline float calibrateAdcVoltage(float value) {
+        return uAdcCalibration.apply(value);
+    }
+
+    inline float calibrateAdcCurrent(float value) {
+        return iAdcCalibration[flags.currentCurrentRange].apply(value);
+    }
+
     /// Set channel voltage level.
     void setVoltage(float voltage);
 
@@ -487,6 +542,7 @@ class Channel {
     float getISetUnbalanced();
 
     uint32_t getCurrentHistoryValuePosition();
+    uint32_t getHistoryRefreshCounter();
 
     void resetHistory();
 
@@ -542,28 +598,25 @@ class Channel {
     
     MaxCurrentLimitCause maxCurrentLimitCause;
 
-    float uHistory[CHANNEL_HISTORY_SIZE];
-    float iHistory[CHANNEL_HISTORY_SIZE];
-    uint32_t historyPosition;
+    ChannelHistory history;
     uint32_t historyLastTick;
 
+    LinearCalibration uDacCalibration;
+    LinearCalibration uAdcCalibration;
+    LinearCalibration iDacCalibration[2];
+    LinearCalibration iAdcCalibration[2];
+
     int reg_get_ques_isum_bit_mask_for_channel_protection_value(ProtectionValue &cpv);
 
-    static float getChannel0HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
-    static float getChannel1HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
-    static float getChannel2HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
-    static float getChannel3HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
-    static float getChannel4HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
-    static float getChannel5HistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
+    template <int CHANNEL_INDEX>
+    static float getChannelHistoryValue(uint32_t rowIndex, uint8_t columnIndex, float *max);
 
     void clearProtectionConf();
     void protectionEnter(ProtectionValue &cpv);
-    void protectionCheck(ProtectionValue &cpv);
+    void protectionCheck(ProtectionValue &cpv, bool state, bool condition, float delay, uint32_t tickCount);
     void protectionCheck();
 
     void doCalibrationEnable(bool enable);
-    bool isVoltageCalibrationEnabled();
-    bool isCurrentCalibrationEnabled();
 
     void addUMonAdcValue(float value);
     void addIMonAdcValue(float value);
@@ -19,6 +19,8 @@
 #include <float.h>
 #include <assert.h>
 
+#include <atomic>
+
 #include <eez/modules/psu/psu.h>
 #include <eez/modules/psu/calibration.h>
 #include <eez/modules/psu/channel_dispatcher.h>
@@ -180,6 +182,7 @@ void setCouplingTypeInPsuThread(CouplingType couplingType) {
                 channel.flags.displayValue1 = channel1.flags.displayValue1;
                 channel.flags.displayValue2 = channel1.flags.displayValue2;
                 channel.ytViewRate = channel1.ytViewRate;
+                channel.adcAveragingNumValues = channel1.adcAveragingNumValues;
 
             }
 
@@ -363,44 +366,95 @@ CouplingType getType() {
 
 #define CONF_GUI_REFRESH_EVERY_MS 250
 
-uint32_t g_lastSnapshotTime;
-
-static struct ChannelSnapshot {
+struct ChannelSnapshot {
     ChannelMode channelMode;
     float uMon;
     float iMon;
-    float pMon;
-} g_channelSnapshots[CH_MAX];
+};
 
-ChannelSnapshot &getChannelSnapshot(int channelIndex) {
-    uint32_t currentTime = micros();
-    if (!g_lastSnapshotTime || currentTime - g_lastSnapshotTime >= CONF_GUI_REFRESH_EVERY_MS * 1000UL) {
-        for (int i = 0; i < CH_NUM; i++) {
-            Channel &channel = Channel::get(i);
-            ChannelSnapshot &channelSnapshot = g_channelSnapshots[i];
-            const char *mode_str = channel.getModeStr();
-            channelSnapshot.uMon = channel_dispatcher::getUMon(channel);
-            channelSnapshot.iMon = channel_dispatcher::getIMon(channel);
-            if (strcmp(mode_str, "CC") == 0) {
-                channelSnapshot.channelMode = CHANNEL_MODE_CC;
-            } else if (strcmp(mode_str, "CV") == 0) {
-                channelSnapshot.channelMode = CHANNEL_MODE_CV;
-            } else {
-                channelSnapshot.channelMode = CHANNEL_MODE_UR;
-            }
-            channelSnapshot.pMon = roundPrec(channelSnapshot.uMon * channelSnapshot.iMon, channel.getPowerResolution());
+// written by the PSU thread
+static ChannelSnapshot g_channelSnapshots[CH_MAX];
+static uint32_t g_lastSnapshotTime;
+static bool g_snapshotPublished;
+
+// odd while PSU thread is writing g_channelSnapshots
+static std::atomic<uint32_t> g_snapshotSequence;
+
+// copy used by the GUI thread
+static ChannelSnapshot g_guiChannelSnapshots[CH_MAX];
+static uint32_t g_guiSnapshotSequence;
+
+static ChannelMode getMode(const Channel &channel) {
+    if (channel.isCvMode()) {
+        return CHANNEL_MODE_CV;
+    } else if (channel.isCcMode()) {
+        return CHANNEL_MODE_CC;
+    } else {
+        return CHANNEL_MODE_UR;
+    }
+}
+
+void updateChannelSnapshots(uint32_t tickCount) {
+    if (g_snapshotPublished && tickCount - g_lastSnapshotTime < CONF_GUI_REFRESH_EVERY_MS * 1000UL) {
+        return;
+    }
+    g_lastSnapshotTime = tickCount;
+
+    bool changed = !g_snapshotPublished;
+    for (int i = 0; i < CH_NUM && !changed; i++) {
+        Channel &channel = Channel::get(i);
+        ChannelSnapshot &channelSnapshot = g_channelSnapshots[i];
+        changed = channelSnapshot.channelMode != getMode(channel) || channelSnapshot.uMon != channel.u.mon || channelSnapshot.iMon != channel.i.mon;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    uint32_t sequence = g_snapshotSequence.load(std::memory_order_relaxed);
+    g_snapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < CH_NUM; i++) {
+        Channel &channel = Channel::get(i);
+        ChannelSnapshot &channelSnapshot = g_channelSnapshots[i];
+        channelSnapshot.channelMode = getMode(channel);
+        channelSnapshot.uMon = channel.u.mon;
+        channelSnapshot.iMon = channel.i.mon;
+    }
+
+    g_snapshotSequence.store(sequence + 2, std::memory_order_release);
+    g_snapshotPublished = true;
+}
+
+// Copies the snapshot if PSU thread published a new one. Values of all the channels returned
+// by the same call are from the same snapshot.
+static const ChannelSnapshot *getChannelSnapshots() {
+    uint32_t sequence = g_snapshotSequence.load(std::memory_order_acquire);
+    while (sequence != g_guiSnapshotSequence) {
+        if (sequence & 1) {
+            sequence = g_snapshotSequence.load(std::memory_order_acquire);
+            continue;
         }
 
-        g_lastSnapshotTime = currentTime;
+        memcpy(g_guiChannelSnapshots, g_channelSnapshots, sizeof(g_channelSnapshots));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t sequenceAfterCopy = g_snapshotSequence.load(std::memory_order_relaxed);
+        if (sequenceAfterCopy == sequence) {
+            g_guiSnapshotSequence = sequence;
+        } else {
+            sequence = sequenceAfterCopy;
+        }
     }
 
-    return g_channelSnapshots[channelIndex];
+    return g_guiChannelSnapshots;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 ChannelMode getChannelMode(const Channel &channel) {
-    return getChannelSnapshot(channel.channelIndex).channelMode;
+    return getChannelSnapshots()[channel.channelIndex].channelMode;
 }
 
 float getTrackingValuePrecision(Unit unit, float value) {
@@ -451,10 +505,11 @@ float getUMon(const Channel &channel) {
 }
 
 float getUMonSnapshot(const Channel &channel) {
+    const ChannelSnapshot *channelSnapshots = getChannelSnapshots();
     if (channel.channelIndex < 2 && g_couplingType == COUPLING_TYPE_SERIES) {
-        return getChannelSnapshot(0).uMon + getChannelSnapshot(1).uMon;
+        return channelSnapshots[0].uMon + channelSnapshots[1].uMon;
     }
-    return getChannelSnapshot(channel.channelIndex).uMon;
+    return channelSnapshots[channel.channelIndex].uMon;
 }
 
 float getUMonLast(const Channel &channel) {
@@ -570,16 +625,99 @@ float getUProtectionLevel(const Channel &channel) {
     return channel.prot_conf.u_level;
 }
 
-static float g_setVoltageValues[CH_MAX];
+// Latest voltage or current set from the other threads. Writer overwrites the value and stores
+// the next setpoint sequence, PSU thread applies only the newest value, so writer never waits for
+// the PSU thread and the last value set is never lost. Sequence is shared by all the mailboxes
+// and it is also put in every PSU queue message, see PSU_QUEUE_MESSAGE.
+// Sequence 0 is never used, it marks the mailbox while the value is written.
+struct SetpointMailbox {
+    std::atomic<float> value;
+    std::atomic<uint32_t> sequence;
+    uint32_t appliedSequence; // accessed only by the PSU thread
+};
+
+static std::atomic<uint32_t> g_setpointSequence;
+static SetpointMailbox g_voltageSetpoints[CH_MAX];
+static SetpointMailbox g_currentSetpoints[CH_MAX];
+
+// PSU queue is flushed every time the sequence crosses this boundary, see postSetpoint
+static const uint32_t SETPOINT_SEQUENCE_FLUSH_PERIOD = (PSU_QUEUE_MESSAGE_SETPOINT_SEQUENCE_MASK + 1) / 2;
+
+uint32_t getSetpointSequence() {
+    return g_setpointSequence.load(std::memory_order_acquire);
+}
+
+static uint32_t nextSetpointSequence() {
+    uint32_t sequence = g_setpointSequence.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (sequence == 0) {
+        sequence = g_setpointSequence.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+#ifndef __EMSCRIPTEN__
+    // Message has only the low bits of the sequence. If the sequence advanced by more than the
+    // mask while a message is in the queue, the message would be handled with a wrong sequence,
+    // so wait for the PSU thread to handle all the queued messages.
+    if (sequence % SETPOINT_SEQUENCE_FLUSH_PERIOD == 0) {
+        while (osMessageWaiting(g_psuMessageQueueId) > 0) {
+            osDelay(1);
+        }
+    }
+#endif
+
+    return sequence;
+}
+
+static void postSetpoint(SetpointMailbox &mailbox, float value) {
+    uint32_t sequence = nextSetpointSequence();
+    mailbox.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mailbox.value.store(value, std::memory_order_relaxed);
+    mailbox.sequence.store(sequence, std::memory_order_release);
+}
+
+static bool takeSetpoint(SetpointMailbox &mailbox, uint32_t lastSequence, float &value) {
+    uint32_t sequence = mailbox.sequence.load(std::memory_order_acquire);
+    if (sequence == 0 || sequence == mailbox.appliedSequence || (int32_t)(sequence - lastSequence) > 0) {
+        return false;
+    }
+
+    value = mailbox.value.load(std::memory_order_relaxed);
 
-void setVoltageInPsuThread(int channelIndex) {
-    setVoltage(Channel::get(channelIndex), g_setVoltageValues[channelIndex]);
+    // if value is overwritten in the meantime, it is taken the next time
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (mailbox.sequence.load(std::memory_order_relaxed) != sequence) {
+        return false;
+    }
+
+    mailbox.appliedSequence = sequence;
+    return true;
+}
+
+static void applySetpointsUpTo(uint32_t lastSequence) {
+    for (int i = 0; i < CH_NUM; i++) {
+        float value;
+        if (takeSetpoint(g_voltageSetpoints[i], lastSequence, value)) {
+            setVoltage(Channel::get(i), value);
+        }
+        if (takeSetpoint(g_currentSetpoints[i], lastSequence, value)) {
+            setCurrent(Channel::get(i), value);
+        }
+    }
+}
+
+void applySetpoints() {
+    applySetpointsUpTo(getSetpointSequence());
+}
+
+void applySetpoints(uint32_t messageSetpointSequence) {
+    // message has only the low bits, sequence can't advance by more than that while the message is in the queue
+    uint32_t sequence = getSetpointSequence();
+    applySetpointsUpTo(sequence - ((sequence - messageSetpointSequence) & PSU_QUEUE_MESSAGE_SETPOINT_SEQUENCE_MASK));
 }
 
 void setVoltage(Channel &channel, float voltage) {
     if (osThreadGetId() != g_psuTaskHandle) {
-        g_setVoltageValues[channel.channelIndex] = voltage;
-        osMessagePut(g_psuMessageQueueId, PSU_QUEUE_MESSAGE(PSU_QUEUE_MESSAGE_TYPE_SET_VOLTAGE, channel.channelIndex), osWaitForever);
+        postSetpoint(g_voltageSetpoints[channel.channelIndex], voltage);
         return;
     }
 
@@ -766,10 +904,11 @@ float getIMon(const Channel &channel) {
 }
 
 float getIMonSnapshot(const Channel &channel) {
+    const ChannelSnapshot *channelSnapshots = getChannelSnapshots();
     if (channel.channelIndex < 2 && g_couplingType == COUPLING_TYPE_PARALLEL) {
-        return getChannelSnapshot(0).iMon + getChannelSnapshot(1).iMon;
+        return channelSnapshots[0].iMon + channelSnapshots[1].iMon;
     }
-    return getChannelSnapshot(channel.channelIndex).iMon;
+    return channelSnapshots[channel.channelIndex].iMon;
 }
 
 float getIMonLast(const Channel &channel) {
@@ -860,16 +999,9 @@ float getIMax(const Channel &channel) {
     return channel.i.max;
 }
 
-static float g_setCurrentValues[CH_MAX];
-
-void setCurrentInPsuThread(int channelIndex) {
-    setCurrent(Channel::get(channelIndex), g_setCurrentValues[channelIndex]);
-}
-
 void setCurrent(Channel &channel, float current) {
     if (osThreadGetId() != g_psuTaskHandle) {
-        g_setCurrentValues[channel.channelIndex] = current;
-        osMessagePut(g_psuMessageQueueId, PSU_QUEUE_MESSAGE(PSU_QUEUE_MESSAGE_TYPE_SET_CURRENT, channel.channelIndex), osWaitForever);
+        postSetpoint(g_currentSetpoints[channel.channelIndex], current);
         return;
     }
 
@@ -1482,6 +1614,22 @@ void setDisplayViewSettings(Channel &channel, int displayValue1, int displayValu
     }
 }
 
+void setAdcAveragingNumValues(Channel &channel, uint8_t numValues) {
+    if (channel.channelIndex < 2 && (g_couplingType == COUPLING_TYPE_SERIES || g_couplingType == COUPLING_TYPE_PARALLEL)) {
+        Channel::get(0).adcAveragingNumValues = numValues;
+        Channel::get(1).adcAveragingNumValues = numValues;
+    } else if (channel.flags.trackingEnabled) {
+        for (int i = 0; i < CH_NUM; ++i) {
+            Channel &trackingChannel = Channel::get(i);
+            if (trackingChannel.flags.trackingEnabled) {
+                trackingChannel.adcAveragingNumValues = numValues;
+            }
+        }
+    } else {
+        channel.adcAveragingNumValues = numValues;
+    }
+}
+
 TriggerMode getVoltageTriggerMode(Channel &channel) {
     if (channel.channelIndex < 2 && (g_couplingType == COUPLING_TYPE_SERIES || g_couplingType == COUPLING_TYPE_PARALLEL)) {
         return Channel::get(0).getVoltageTriggerMode();
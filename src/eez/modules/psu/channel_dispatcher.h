@@ -45,6 +45,11 @@ enum ChannelMode {
     CHANNEL_MODE_CV
 };
 
+// Mode and mon values shown by the GUI are taken from the snapshot, which is updated in the PSU
+// thread (updateChannelSnapshots) at most every CONF_GUI_REFRESH_EVERY_MS, only if something is
+// changed. Snapshot getters should be called only from the GUI thread.
+void updateChannelSnapshots(uint32_t tickCount);
+
 ChannelMode getChannelMode(const Channel &channel);
 
 float getValuePrecision(const Channel &channel, Unit unit, float value);
@@ -132,6 +137,8 @@ void setOtpDelay(int sensor, float delay);
 
 void setDisplayViewSettings(Channel &channel, int displayValue1, int displayValue2, float ytViewRate);
 
+void setAdcAveragingNumValues(Channel &channel, uint8_t numValues);
+
 TriggerMode getVoltageTriggerMode(Channel &channel);
 void setVoltageTriggerMode(Channel &channel, TriggerMode mode);
 
@@ -163,8 +170,15 @@ void setLoadEnabled(Channel &channel, bool state);
 void setLoad(Channel &channel, float load);
 #endif
 
-void setVoltageInPsuThread(int channelIndex);
-void setCurrentInPsuThread(int channelIndex);
+// Applies voltage and current set from the other threads since the last call.
+// Called in the PSU thread every tick.
+void applySetpoints();
+
+// Called in the PSU thread before every message with the setpoint sequence the message was
+// posted with. Only voltage and current set before the message was posted are applied, so the
+// order of setting the voltage/current and sending the message (e.g. output enable, *RST,
+// coupling change) is preserved. Voltage and current set later are applied after the message.
+void applySetpoints(uint32_t messageSetpointSequence);
 
 } // namespace channel_dispatcher
 } // namespace psu
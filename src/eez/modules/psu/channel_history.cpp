@@ -0,0 +1,168 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <eez/modules/psu/psu.h>
+
+#include <eez/modules/psu/channel_history.h>
+
+#include <eez/memory.h>
+
+namespace eez {
+namespace psu {
+
+static_assert(CH_MAX * ChannelHistory::BUFFER_SIZE <= CHANNEL_HISTORY_BUFFER_SIZE, "CHANNEL_HISTORY_BUFFER is too small");
+
+static void initMinMaxEntry(ChannelHistory::MinMaxEntry &entry) {
+    entry.uMin = INFINITY;
+    entry.uMax = -INFINITY;
+    entry.iMin = INFINITY;
+    entry.iMax = -INFINITY;
+    entry.pMin = INFINITY;
+    entry.pMax = -INFINITY;
+}
+
+static void mergeMinMaxEntry(ChannelHistory::MinMaxEntry &entry, const ChannelHistory::MinMaxEntry &other) {
+    if (other.uMin < entry.uMin) {
+        entry.uMin = other.uMin;
+    }
+    if (other.uMax > entry.uMax) {
+        entry.uMax = other.uMax;
+    }
+    if (other.iMin < entry.iMin) {
+        entry.iMin = other.iMin;
+    }
+    if (other.iMax > entry.iMax) {
+        entry.iMax = other.iMax;
+    }
+    if (other.pMin < entry.pMin) {
+        entry.pMin = other.pMin;
+    }
+    if (other.pMax > entry.pMax) {
+        entry.pMax = other.pMax;
+    }
+}
+
+void ChannelHistory::reset(int channelIndex) {
+    uint8_t *buffer = CHANNEL_HISTORY_BUFFER + channelIndex * BUFFER_SIZE;
+
+    m_rawEntries = (RawEntry *)buffer;
+    buffer += RAW_TIER_SIZE * sizeof(RawEntry);
+
+    for (int tier = 1; tier < NUM_TIERS; tier++) {
+        m_minMaxEntries[tier - 1] = (MinMaxEntry *)buffer;
+        buffer += MIN_MAX_TIER_SIZE * sizeof(MinMaxEntry);
+
+        initMinMaxEntry(m_pendingEntries[tier - 1]);
+    }
+
+    for (int tier = 0; tier < NUM_TIERS; tier++) {
+        m_numEntries[tier] = 0;
+    }
+}
+
+void ChannelHistory::addValue(float u, float i) {
+    RawEntry &rawEntry = m_rawEntries[m_numEntries[0] % RAW_TIER_SIZE];
+    rawEntry.u = u;
+    rawEntry.i = i;
+    m_numEntries[0]++;
+
+    float p = u * i;
+    MinMaxEntry entry = { u, u, i, i, p, p };
+
+    for (int tier = 1; tier < NUM_TIERS; tier++) {
+        MinMaxEntry &pendingEntry = m_pendingEntries[tier - 1];
+        mergeMinMaxEntry(pendingEntry, entry);
+
+        if (m_numEntries[tier - 1] % (1 << TIER_FACTOR_SHIFT) != 0) {
+            break;
+        }
+
+        // pending entry is complete, add it to the tier and merge it into the next one
+        entry = pendingEntry;
+        m_minMaxEntries[tier - 1][m_numEntries[tier] % MIN_MAX_TIER_SIZE] = entry;
+        m_numEntries[tier]++;
+        initMinMaxEntry(pendingEntry);
+    }
+}
+
+int ChannelHistory::getTier(uint32_t rate) {
+    int tier = 0;
+    while (tier < NUM_TIERS - 1 && (BASE_PERIOD << ((tier + 1) * TIER_FACTOR_SHIFT)) <= rate) {
+        tier++;
+    }
+    return tier;
+}
+
+uint32_t ChannelHistory::getTierSize(int tier) {
+    return tier == 0 ? RAW_TIER_SIZE : MIN_MAX_TIER_SIZE;
+}
+
+void ChannelHistory::getEntry(int tier, uint32_t entryIndex, MinMaxEntry &entry) {
+    if (tier == 0) {
+        const RawEntry &rawEntry = m_rawEntries[entryIndex % RAW_TIER_SIZE];
+        entry.uMin = entry.uMax = rawEntry.u;
+        entry.iMin = entry.iMax = rawEntry.i;
+        entry.pMin = entry.pMax = rawEntry.u * rawEntry.i;
+    } else {
+        entry = m_minMaxEntries[tier - 1][entryIndex % MIN_MAX_TIER_SIZE];
+    }
+}
+
+uint32_t ChannelHistory::getNumPoints(uint32_t rate) {
+    int tier = getTier(rate);
+    return (uint32_t)((uint64_t)m_numEntries[tier] * (BASE_PERIOD << (tier * TIER_FACTOR_SHIFT)) / rate);
+}
+
+bool ChannelHistory::getPoint(uint32_t pointIndex, uint32_t rate, ValueType valueType, float &min, float &max) {
+    int tier = getTier(rate);
+    uint32_t tierPeriod = BASE_PERIOD << (tier * TIER_FACTOR_SHIFT);
+
+    // tier entries [start, end) covered by the point
+    uint32_t start = (uint32_t)((uint64_t)pointIndex * rate / tierPeriod);
+    uint32_t end = (uint32_t)((uint64_t)(pointIndex + 1) * rate / tierPeriod);
+
+    uint32_t numEntries = m_numEntries[tier];
+    uint32_t tierSize = getTierSize(tier);
+    if (end > numEntries || start >= end || (numEntries > tierSize && start < numEntries - tierSize)) {
+        return false;
+    }
+
+    MinMaxEntry point;
+    initMinMaxEntry(point);
+    for (uint32_t entryIndex = start; entryIndex < end; entryIndex++) {
+        MinMaxEntry entry;
+        getEntry(tier, entryIndex, entry);
+        mergeMinMaxEntry(point, entry);
+    }
+
+    if (valueType == VALUE_TYPE_U) {
+        min = point.uMin;
+        max = point.uMax;
+    } else if (valueType == VALUE_TYPE_I) {
+        min = point.iMin;
+        max = point.iMax;
+    } else {
+        min = point.pMin;
+        max = point.pMax;
+    }
+
+    return true;
+}
+
+} // namespace psu
+} // namespace eez
@@ -0,0 +1,105 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <eez/modules/psu/conf_advanced.h>
+
+/* Channel History
+
+U and I are sampled every BASE_PERIOD, independently of the YT view rate, and kept in tiers:
+
+TIER  PERIOD   VALUES              ENTRIES  ENTRY SIZE  MEMORY    COVERS
+------------------------------------------------------------------------
+0     10 ms    U, I                512      8 B         4 KB      5.1 s
+1     80 ms    U, I, P min/max     1360     24 B        31.9 KB   1.8 min
+2     640 ms   U, I, P min/max     1360     24 B        31.9 KB   14.5 min
+------------------------------------------------------------------------
+                                                        67.8 KB per channel (CHANNEL_HISTORY_BUFFER)
+
+YT view point at the view rate is taken from the tier with the longest period that is not longer
+than the view rate, as min/max of the tier entries it covers. So the view rate can be changed
+without losing the history, and points show the envelope of all the samples, not just one sample.
+P min/max is taken from the U * I of every sample, not from the U and I envelopes, because the
+min U and the max I are usually not from the same sample.
+At view rates above ~1.8 s less than 480 points are available.
+*/
+
+namespace eez {
+namespace psu {
+
+class ChannelHistory {
+public:
+    enum ValueType {
+        VALUE_TYPE_U,
+        VALUE_TYPE_I,
+        VALUE_TYPE_P
+    };
+
+    static const int NUM_TIERS = 3;
+    static const uint32_t TIER_FACTOR_SHIFT = 3; // x8
+    static const uint32_t BASE_PERIOD = (uint32_t)(GUI_YT_VIEW_RATE_MIN * 1000000); // in microseconds
+    static const uint32_t RAW_TIER_SIZE = CHANNEL_HISTORY_SIZE;
+    static const uint32_t MIN_MAX_TIER_SIZE = 1360;
+
+    struct RawEntry {
+        float u;
+        float i;
+    };
+
+    struct MinMaxEntry {
+        float uMin;
+        float uMax;
+        float iMin;
+        float iMax;
+        float pMin;
+        float pMax;
+    };
+
+    static const uint32_t BUFFER_SIZE = RAW_TIER_SIZE * sizeof(RawEntry) + (NUM_TIERS - 1) * MIN_MAX_TIER_SIZE * sizeof(MinMaxEntry);
+
+    void reset(int channelIndex);
+
+    // should be called every BASE_PERIOD
+    void addValue(float u, float i);
+
+    // number of the complete points at the view rate (in microseconds)
+    uint32_t getNumPoints(uint32_t rate);
+
+    // min/max of the values in the point, returns false if they are not available anymore
+    bool getPoint(uint32_t pointIndex, uint32_t rate, ValueType valueType, float &min, float &max);
+
+private:
+    RawEntry *m_rawEntries;
+    MinMaxEntry *m_minMaxEntries[NUM_TIERS - 1];
+
+    // number of entries added to the tier since reset
+    uint32_t m_numEntries[NUM_TIERS];
+
+    // entries of the min/max tiers that are not complete yet
+    MinMaxEntry m_pendingEntries[NUM_TIERS - 1];
+
+    static int getTier(uint32_t rate);
+    uint32_t getTierSize(int tier);
+    void getEntry(int tier, uint32_t entryIndex, MinMaxEntry &entry);
+};
+
+} // namespace psu
+} // namespace eez
@@ -243,6 +243,9 @@
 /// Number of values used for ADC averaging
 #define NUM_ADC_AVERAGING_VALUES 30
 
+/// Max. number of values used for ADC averaging, when changed with SENS:AVER:COUN
+#define NUM_ADC_AVERAGING_VALUES_MAX 64
+
 /// Width of the trigger output pulse, in milliseconds.
 #define CONF_TOUTPUT_PULSE_WIDTH_MS 100
 
@@ -266,6 +269,10 @@
 /// Size of serial port output buffer
 #define CONF_SERIAL_BUFFER_SIZE 1024
 
+/// Max. number of bytes sent by the single MMEMory:UPLoad:CHUNk? query
+#define CONF_UPLOAD_CHUNK_MAX_SIZE_SERIAL (16 * 1024)
+#define CONF_UPLOAD_CHUNK_MAX_SIZE_ETHERNET (64 * 1024)
+
 // Default duration of all animations in seconds
 #define CONF_DEFAULT_ANIMATIONS_DURATION 0.15f
 
@@ -29,6 +29,10 @@ namespace psu {
 namespace debug {
 
 DebugCounterVariable g_adcCounter("ADC_COUNTER");
+DebugCounterVariable g_dlogCacheHit("DLOG_CACHE_HIT");
+DebugCounterVariable g_dlogCacheMiss("DLOG_CACHE_MISS");
+DebugCounterVariable g_dlogReadAhead("DLOG_READ_AHEAD");
+DebugDurationVariable g_dlogBlockLoadDuration("DLOG_BLOCK_LOAD");
 DebugValueVariable g_uDac[CH_MAX] = { DebugValueVariable("CH1 U_DAC"), DebugValueVariable("CH2 U_DAC"), DebugValueVariable("CH3 U_DAC"), DebugValueVariable("CH4 U_DAC"), DebugValueVariable("CH5 U_DAC"), DebugValueVariable("CH6 U_DAC") };
 DebugValueVariable g_uMon[CH_MAX] = { DebugValueVariable("CH1 U_MON"), DebugValueVariable("CH2 U_MON"), DebugValueVariable("CH3 U_MON"), DebugValueVariable("CH4 U_MON"), DebugValueVariable("CH5 U_MON"), DebugValueVariable("CH6 U_MON") };
 DebugValueVariable g_uMonDac[CH_MAX] = { DebugValueVariable("CH1 U_MON_DAC"), DebugValueVariable("CH2 U_MON_DAC"), DebugValueVariable("CH3 U_MON_DAC"), DebugValueVariable("CH4 U_MON_DAC"), DebugValueVariable("CH5 U_MON_DAC"), DebugValueVariable("CH6 U_MON_DAC") };
@@ -38,6 +42,7 @@ DebugValueVariable g_iMonDac[CH_MAX] = { DebugValueVariable("CH1 I_MON_DAC"), De
 
 DebugVariable *g_variables[] = { 
     &g_adcCounter,
+    &g_dlogCacheHit, &g_dlogCacheMiss, &g_dlogReadAhead, &g_dlogBlockLoadDuration,
     &g_uDac[0], &g_uMon[0], &g_uMonDac[0], &g_iDac[0], &g_iMon[0], &g_iMonDac[0],
     &g_uDac[1], &g_uMon[1], &g_uMonDac[1], &g_iDac[1], &g_iMon[1], &g_iMonDac[1],
     &g_uDac[2], &g_uMon[2], &g_uMonDac[2], &g_iDac[2], &g_iMon[2], &g_iMonDac[2],
@@ -35,6 +35,10 @@ namespace debug {
 void tick(uint32_t tickCount);
 
 extern DebugCounterVariable g_adcCounter;
+extern DebugCounterVariable g_dlogCacheHit;
+extern DebugCounterVariable g_dlogCacheMiss;
+extern DebugCounterVariable g_dlogReadAhead;
+extern DebugDurationVariable g_dlogBlockLoadDuration;
 extern DebugValueVariable g_uDac[CH_MAX];
 extern DebugValueVariable g_uMon[CH_MAX];
 extern DebugValueVariable g_uMonDac[CH_MAX];
@@ -0,0 +1,314 @@
+/*
+* EEZ PSU Firmware
+* Copyright (C) 2020-present, Envox d.o.o.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include <eez/modules/psu/psu.h>
+
+#include <eez/modules/psu/dlog_codec.h>
+
+namespace eez {
+namespace psu {
+namespace dlog_codec {
+
+// leadingZeros value used before the first XOR with non zero value
+static const uint8_t NO_WINDOW = 0xFF;
+
+static uint32_t countLeadingZeros(uint32_t value) {
+    uint32_t n = 0;
+    for (uint32_t mask = 0x80000000; mask && !(value & mask); mask >>= 1) {
+        n++;
+    }
+    return n;
+}
+
+static uint32_t countTrailingZeros(uint32_t value) {
+    uint32_t n = 0;
+    for (uint32_t mask = 1; mask && !(value & mask); mask <<= 1) {
+        n++;
+    }
+    return n;
+}
+
+static void mergeRange(dlog_view::Range &range, float value) {
+    // NaN is a gap in the recording and it is ignored
+    if (isnan(range.min) || value < range.min) {
+        range.min = value;
+    }
+    if (isnan(range.max) || value > range.max) {
+        range.max = value;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BlockEncoder::start(uint8_t *block, uint32_t numColumns, uint32_t firstRow) {
+    m_block = block;
+    m_numColumns = numColumns;
+    m_firstRow = firstRow;
+    m_numRows = 0;
+    m_bitPosition = 0;
+    m_maxBitPosition = (BLOCK_SIZE - getBlockDataOffset(numColumns)) * 8;
+
+    memset(m_block, 0, BLOCK_SIZE);
+
+    for (uint32_t i = 0; i < m_numColumns; i++) {
+        m_ranges[i].min = NAN;
+        m_ranges[i].max = NAN;
+    }
+}
+
+bool BlockEncoder::addRow(const float *values) {
+    if (m_numRows == MAX_NUM_ROWS_PER_BLOCK) {
+        return false;
+    }
+
+    uint32_t savedBitPosition = m_bitPosition;
+    ColumnState savedColumns[dlog_view::MAX_NUM_OF_Y_AXES];
+    memcpy(savedColumns, m_columns, m_numColumns * sizeof(ColumnState));
+
+    for (uint32_t i = 0; i < m_numColumns; i++) {
+        uint32_t value;
+        memcpy(&value, values + i, sizeof(float));
+
+        if (m_numRows == 0) {
+            writeBits(value, 32);
+            m_columns[i].previous = value;
+            m_columns[i].leadingZeros = NO_WINDOW;
+            m_columns[i].trailingZeros = 0;
+        } else {
+            encodeValue(m_columns[i], value);
+        }
+    }
+
+    if (m_bitPosition > m_maxBitPosition) {
+        m_bitPosition = savedBitPosition;
+        memcpy(m_columns, savedColumns, m_numColumns * sizeof(ColumnState));
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_numColumns; i++) {
+        mergeRange(m_ranges[i], values[i]);
+    }
+
+    m_numRows++;
+
+    return true;
+}
+
+uint32_t BlockEncoder::finish() {
+    uint16_t numRows = (uint16_t)m_numRows;
+    uint16_t dataLength = (uint16_t)((m_bitPosition + 7) / 8);
+
+    memcpy(m_block, &m_firstRow, sizeof(uint32_t));
+    memcpy(m_block + 4, &numRows, sizeof(uint16_t));
+    memcpy(m_block + 6, &dataLength, sizeof(uint16_t));
+    memcpy(m_block + BLOCK_HEADER_SIZE, m_ranges, m_numColumns * sizeof(dlog_view::Range));
+
+    return getBlockDataOffset(m_numColumns) + dataLength;
+}
+
+void BlockEncoder::writeBits(uint32_t value, uint32_t numBits) {
+    uint8_t *data = m_block + getBlockDataOffset(m_numColumns);
+
+    while (numBits--) {
+        // bits after m_maxBitPosition are only counted, so addRow can detect overflow
+        if (m_bitPosition < m_maxBitPosition) {
+            uint8_t *p = data + (m_bitPosition >> 3);
+            uint8_t mask = 0x80 >> (m_bitPosition & 7);
+            if ((value >> numBits) & 1) {
+                *p |= mask;
+            } else {
+                *p &= ~mask;
+            }
+        }
+        m_bitPosition++;
+    }
+}
+
+void BlockEncoder::encodeValue(ColumnState &column, uint32_t value) {
+    uint32_t xorValue = value ^ column.previous;
+
+    if (xorValue == 0) {
+        writeBits(0, 1);
+    } else {
+        writeBits(1, 1);
+
+        uint32_t leadingZeros = countLeadingZeros(xorValue);
+        uint32_t trailingZeros = countTrailingZeros(xorValue);
+
+        if (column.leadingZeros != NO_WINDOW && leadingZeros >= column.leadingZeros && trailingZeros >= column.trailingZeros) {
+            // meaningful bits fit inside the previous window
+            writeBits(0, 1);
+            writeBits(xorValue >> column.trailingZeros, 32 - column.leadingZeros - column.trailingZeros);
+        } else {
+            uint32_t numMeaningfulBits = 32 - leadingZeros - trailingZeros;
+            writeBits(1, 1);
+            writeBits(leadingZeros, 5);
+            writeBits(numMeaningfulBits - 1, 5);
+            writeBits(xorValue >> trailingZeros, numMeaningfulBits);
+
+            column.leadingZeros = (uint8_t)leadingZeros;
+            column.trailingZeros = (uint8_t)trailingZeros;
+        }
+    }
+
+    column.previous = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool readBlockHeader(const uint8_t *block, uint32_t numColumns, BlockHeader &header, dlog_view::Range *ranges) {
+    memcpy(&header.firstRow, block, sizeof(uint32_t));
+    memcpy(&header.numRows, block + 4, sizeof(uint16_t));
+    memcpy(&header.dataLength, block + 6, sizeof(uint16_t));
+    memcpy(ranges, block + BLOCK_HEADER_SIZE, numColumns * sizeof(dlog_view::Range));
+
+    return header.numRows > 0 && getBlockDataOffset(numColumns) + header.dataLength <= BLOCK_SIZE;
+}
+
+bool BlockDecoder::start(const uint8_t *block, uint32_t blockLength, uint32_t numColumns) {
+    if (numColumns > dlog_view::MAX_NUM_OF_Y_AXES || blockLength < getBlockDataOffset(numColumns)) {
+        return false;
+    }
+
+    if (!readBlockHeader(block, numColumns, m_header, m_ranges)) {
+        return false;
+    }
+
+    if (getBlockDataOffset(numColumns) + m_header.dataLength > blockLength) {
+        return false;
+    }
+
+    m_data = block + getBlockDataOffset(numColumns);
+    m_numColumns = numColumns;
+    m_rowIndex = 0;
+    m_bitPosition = 0;
+    m_maxBitPosition = m_header.dataLength * 8;
+
+    return true;
+}
+
+bool BlockDecoder::readRow(float *values) {
+    if (m_rowIndex >= m_header.numRows) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_numColumns; i++) {
+        uint32_t value;
+
+        if (m_rowIndex == 0) {
+            if (!readBits(32, value)) {
+                return false;
+            }
+            m_columns[i].previous = value;
+            m_columns[i].leadingZeros = NO_WINDOW;
+            m_columns[i].trailingZeros = 0;
+        } else {
+            if (!decodeValue(m_columns[i], value)) {
+                return false;
+            }
+        }
+
+        memcpy(values + i, &value, sizeof(float));
+    }
+
+    m_rowIndex++;
+
+    return true;
+}
+
+bool BlockDecoder::skipRows(uint32_t numRows) {
+    float values[dlog_view::MAX_NUM_OF_Y_AXES];
+    while (numRows--) {
+        if (!readRow(values)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BlockDecoder::readBits(uint32_t numBits, uint32_t &value) {
+    if (m_bitPosition + numBits > m_maxBitPosition) {
+        return false;
+    }
+
+    value = 0;
+    while (numBits--) {
+        value = (value << 1) | ((m_data[m_bitPosition >> 3] >> (7 - (m_bitPosition & 7))) & 1);
+        m_bitPosition++;
+    }
+
+    return true;
+}
+
+bool BlockDecoder::decodeValue(ColumnState &column, uint32_t &value) {
+    uint32_t bit;
+    if (!readBits(1, bit)) {
+        return false;
+    }
+
+    if (bit == 0) {
+        value = column.previous;
+        return true;
+    }
+
+    if (!readBits(1, bit)) {
+        return false;
+    }
+
+    uint32_t xorValue;
+
+    if (bit == 0) {
+        if (column.leadingZeros == NO_WINDOW) {
+            return false;
+        }
+        if (!readBits(32 - column.leadingZeros - column.trailingZeros, xorValue)) {
+            return false;
+        }
+        xorValue <<= column.trailingZeros;
+    } else {
+        uint32_t leadingZeros;
+        uint32_t numMeaningfulBits;
+        if (!readBits(5, leadingZeros) || !readBits(5, numMeaningfulBits)) {
+            return false;
+        }
+        numMeaningfulBits++;
+        if (leadingZeros + numMeaningfulBits > 32) {
+            return false;
+        }
+        uint32_t trailingZeros = 32 - leadingZeros - numMeaningfulBits;
+        if (!readBits(numMeaningfulBits, xorValue)) {
+            return false;
+        }
+        xorValue <<= trailingZeros;
+
+        column.leadingZeros = (uint8_t)leadingZeros;
+        column.trailingZeros = (uint8_t)trailingZeros;
+    }
+
+    value = column.previous ^ xorValue;
+    column.previous = value;
+
+    return true;
+}
+
+} // namespace dlog_codec
+} // namespace psu
+} // namespace eez
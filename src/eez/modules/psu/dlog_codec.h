@@ -0,0 +1,134 @@
+/*
+* EEZ PSU Firmware
+* Copyright (C) 2020-present, Envox d.o.o.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <eez/modules/psu/dlog_view.h>
+
+/* DLOG Compressed Data Block
+
+Data section of the VERSION3 dlog file is a sequence of BLOCK_SIZE blocks, only the last block
+can be shorter. Every block can be decoded independently of other blocks. Values are compressed
+with XOR encoding (as in Facebook's Gorilla TSDB): each value is XOR-ed with the previous value
+of the same column and only meaningful bits of the result are stored. First row of the block
+is stored uncompressed.
+
+OFFSET          TYPE    WIDTH    DESCRIPTION
+----------------------------------------------------------------------
+0               U32     4        Index of the first row in the block
+
+4               U16     2        Number of rows in the block
+
+6               U16     2        Length of the compressed rows in bytes
+
+8+m*8           Float   4        Min. value of the m-th column
+
+12+m*8          Float   4        Max. value of the m-th column
+
+8+N*8           Bits    Length   Compressed rows, N - number of columns
+*/
+
+namespace eez {
+namespace psu {
+namespace dlog_codec {
+
+static const uint32_t BLOCK_SIZE = 4096;
+static const uint32_t BLOCK_HEADER_SIZE = 8;
+static const uint32_t MAX_NUM_ROWS_PER_BLOCK = 65535;
+
+struct BlockHeader {
+    uint32_t firstRow;
+    uint16_t numRows;
+    uint16_t dataLength;
+};
+
+inline uint32_t getBlockDataOffset(uint32_t numColumns) {
+    return BLOCK_HEADER_SIZE + numColumns * sizeof(dlog_view::Range);
+}
+
+struct ColumnState {
+    uint32_t previous;
+    uint8_t leadingZeros;
+    uint8_t trailingZeros;
+};
+
+class BlockEncoder {
+public:
+    // block must point to the buffer of BLOCK_SIZE bytes
+    void start(uint8_t *block, uint32_t numColumns, uint32_t firstRow);
+
+    // returns false, and leaves the block unchanged, if row doesn't fit in the block
+    bool addRow(const float *values);
+
+    // writes block header and returns the number of used bytes,
+    // more rows can be added after this and block finished again
+    uint32_t finish();
+
+    uint32_t getFirstRow() const { return m_firstRow; }
+    uint32_t getNumRows() const { return m_numRows; }
+
+private:
+    uint8_t *m_block;
+    uint32_t m_numColumns;
+    uint32_t m_firstRow;
+    uint32_t m_numRows;
+    uint32_t m_bitPosition;
+    uint32_t m_maxBitPosition;
+    dlog_view::Range m_ranges[dlog_view::MAX_NUM_OF_Y_AXES];
+    ColumnState m_columns[dlog_view::MAX_NUM_OF_Y_AXES];
+
+    void writeBits(uint32_t value, uint32_t numBits);
+    void encodeValue(ColumnState &column, uint32_t value);
+};
+
+class BlockDecoder {
+public:
+    // returns false if block header is not valid
+    bool start(const uint8_t *block, uint32_t blockLength, uint32_t numColumns);
+
+    const BlockHeader &getHeader() const { return m_header; }
+    const dlog_view::Range *getRanges() const { return m_ranges; }
+
+    // index of the row that will be returned by the next readRow
+    uint32_t getRowIndex() const { return m_header.firstRow + m_rowIndex; }
+
+    bool readRow(float *values);
+    bool skipRows(uint32_t numRows);
+
+private:
+    const uint8_t *m_data;
+    uint32_t m_numColumns;
+    BlockHeader m_header;
+    dlog_view::Range m_ranges[dlog_view::MAX_NUM_OF_Y_AXES];
+    uint32_t m_rowIndex;
+    uint32_t m_bitPosition;
+    uint32_t m_maxBitPosition;
+    ColumnState m_columns[dlog_view::MAX_NUM_OF_Y_AXES];
+
+    bool readBits(uint32_t numBits, uint32_t &value);
+    bool decodeValue(ColumnState &column, uint32_t &value);
+};
+
+// reads only the header and column ranges of the block
+bool readBlockHeader(const uint8_t *block, uint32_t numColumns, BlockHeader &header, dlog_view::Range *ranges);
+
+} // namespace dlog_codec
+} // namespace psu
+} // namespace eez
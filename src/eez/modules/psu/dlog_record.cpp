@@ -30,7 +30,9 @@
 #include <eez/modules/psu/scpi/psu.h>
 #include <eez/modules/psu/sd_card.h>
 #include <eez/system.h>
+#include <eez/spsc_ring.h>
 #include <eez/modules/psu/dlog_record.h>
+#include <eez/modules/psu/dlog_codec.h>
 #include <eez/modules/psu/event_queue.h>
 #include <eez/gui/widgets/yt_graph.h>
 
@@ -44,6 +46,7 @@ namespace psu {
 namespace dlog_record {
 
 #define CHUNK_SIZE 4096
+#define MAX_WRITE_SIZE (64 * 1024)
 
 enum Event {
     EVENT_INITIATE,
@@ -67,9 +70,12 @@ dlog_view::Parameters g_parameters = {
     {false, false, false, false, false, false},
     {false, false, false, false, false, false},
     {false, false, false, false, false, false},
+    false,
     PERIOD_DEFAULT,
     TIME_DEFAULT,
-    trigger::SOURCE_IMMEDIATE
+    trigger::SOURCE_IMMEDIATE,
+    false,
+    { false, 0, 0, DEADBAND_MAX_INTERVAL_DEFAULT }
 };
 
 dlog_view::Parameters g_guiParameters = {
@@ -83,9 +89,12 @@ dlog_view::Parameters g_guiParameters = {
     {true, false, false, false, false, false},
     {true, false, false, false, false, false},
     {false, false, false, false, false, false},
+    false,
     PERIOD_DEFAULT,
     TIME_DEFAULT,
-    trigger::SOURCE_IMMEDIATE
+    trigger::SOURCE_IMMEDIATE,
+    false,
+    { false, 0, 0, DEADBAND_MAX_INTERVAL_DEFAULT }
 };
 
 trigger::Source g_triggerSource = trigger::SOURCE_IMMEDIATE;
@@ -104,14 +113,47 @@ static uint32_t g_iSample;
 double g_currentTime;
 static double g_nextTime;
 uint32_t g_fileLength;
-static unsigned int g_bufferIndex;
-static unsigned int g_lastSavedBufferIndex;
-static unsigned int g_saveUpToBufferIndex;
+
+// updated by the PSU thread on every sample
+static Statistics g_statistics;
+static bool g_sampleTaken;
+static uint32_t g_lastSampleTickCount;
+
+// last row that was written in deadband mode
+static float g_deadbandRow[dlog_view::MAX_NUM_OF_Y_AXES];
+static bool g_deadbandRowValid;
+static double g_deadbandRowTime;
+
+// Recorded data is written into the ring by the PSU thread and saved to the file by the SCPI thread.
+// If ring is full, the rest of the recording is dropped and SCPI thread aborts the recording.
+static SpscRing<uint8_t> g_ring;
+static std::atomic<bool> g_bufferOverflow;
+
+// file is kept open for the whole STATE_EXECUTING and it is accessed only from the SCPI thread
+static File g_file;
+static bool g_fileIsOpen;
+// set by the PSU thread and cleared by the SCPI thread
+static std::atomic<bool> g_fileWritePending;
+static std::atomic<bool> g_syncRequested;
+
+// block of the compressed data (VERSION3) that is currently filled, it is accessed only from the SCPI thread
+static dlog_codec::BlockEncoder g_blockEncoder;
+static uint32_t g_blockIndex;
+
+// Min/max of every column for the last recorded rows, in chunks of RANGE_CHUNK_NUM_ROWS rows.
+// It is updated while rows are recorded, so scaleToFit doesn't have to scan the whole page.
+static const uint32_t RANGE_CHUNK_NUM_ROWS = 32;
+static const uint32_t NUM_RANGE_CHUNKS = 480 / RANGE_CHUNK_NUM_ROWS + 2;
+static dlog_view::Range g_rangeChunks[NUM_RANGE_CHUNKS][MAX_NUM_OF_Y_VALUES];
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static float getRawValue(uint32_t rowIndex, uint8_t columnIndex) {
+    return *(float *)(DLOG_RECORD_BUFFER + (g_recording.dataOffset + (rowIndex * g_recording.parameters.numYAxes + columnIndex) * 4) % DLOG_RECORD_BUFFER_SIZE);
+}
+
 static float getValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
-    float value = *(float *)(DLOG_RECORD_BUFFER + (g_recording.dataOffset + (rowIndex * g_recording.parameters.numYAxes + columnIndex) * 4) % DLOG_RECORD_BUFFER_SIZE);
+    float value = getRawValue(rowIndex, columnIndex);
 
     if (g_recording.parameters.yAxisScale == dlog_view::SCALE_LOGARITHMIC) {
         float logOffset = 1 - g_recording.parameters.yAxes[columnIndex].range.min;
@@ -122,68 +164,226 @@ static float getValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
     return value;
 }
 
+static void mergeRange(dlog_view::Range &range, float value) {
+    // NaN is a gap in the recording and it is ignored
+    if (isnan(range.min) || value < range.min) {
+        range.min = value;
+    }
+    if (isnan(range.max) || value > range.max) {
+        range.max = value;
+    }
+}
+
+static void updateRangeChunk(const float *values, uint32_t numValues) {
+    dlog_view::Range *ranges = g_rangeChunks[(g_recording.size / RANGE_CHUNK_NUM_ROWS) % NUM_RANGE_CHUNKS];
+    bool firstRowInChunk = g_recording.size % RANGE_CHUNK_NUM_ROWS == 0;
+    for (uint32_t i = 0; i < MIN(numValues, MAX_NUM_OF_Y_VALUES); i++) {
+        if (firstRowInChunk) {
+            ranges[i].min = ranges[i].max = values[i];
+        } else {
+            mergeRange(ranges[i], values[i]);
+        }
+    }
+}
+
+static bool getRange(uint32_t rowIndex, uint32_t numRows, uint8_t columnIndex, float *min, float *max) {
+    uint32_t size = g_recording.size;
+    uint32_t endRowIndex = MIN(rowIndex + numRows, size);
+
+    if (size > (NUM_RANGE_CHUNKS - 1) * RANGE_CHUNK_NUM_ROWS && rowIndex < size - (NUM_RANGE_CHUNKS - 1) * RANGE_CHUNK_NUM_ROWS) {
+        // chunk is already reused
+        return false;
+    }
+
+    dlog_view::Range range = { NAN, NAN };
+
+    while (rowIndex < endRowIndex) {
+        uint32_t chunkStart = rowIndex / RANGE_CHUNK_NUM_ROWS * RANGE_CHUNK_NUM_ROWS;
+        uint32_t chunkEnd = MIN(chunkStart + RANGE_CHUNK_NUM_ROWS, size);
+        if (rowIndex == chunkStart && chunkEnd <= endRowIndex) {
+            dlog_view::Range &chunkRange = g_rangeChunks[(chunkStart / RANGE_CHUNK_NUM_ROWS) % NUM_RANGE_CHUNKS][columnIndex];
+            if (!isnan(chunkRange.min)) {
+                mergeRange(range, chunkRange.min);
+                mergeRange(range, chunkRange.max);
+            }
+            rowIndex = chunkEnd;
+        } else {
+            for (; rowIndex < MIN(chunkEnd, endRowIndex); rowIndex++) {
+                mergeRange(range, getRawValue(rowIndex, columnIndex));
+            }
+        }
+    }
+
+    if (isnan(range.min)) {
+        return false;
+    }
+
+    if (g_recording.parameters.yAxisScale == dlog_view::SCALE_LOGARITHMIC) {
+        float logOffset = 1 - g_recording.parameters.yAxes[columnIndex].range.min;
+        *min = log10f(logOffset + range.min);
+        *max = log10f(logOffset + range.max);
+    } else {
+        *min = range.min;
+        *max = range.max;
+    }
+
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
-static int fileTruncate() {
-    File file;
-    if (!file.open(g_parameters.filePath, FILE_OPEN_APPEND | FILE_WRITE)) {
+static int fileOpen() {
+    if (!g_file.open(g_parameters.filePath, FILE_CREATE_ALWAYS | FILE_WRITE)) {
         event_queue::pushEvent(event_queue::EVENT_ERROR_DLOG_FILE_OPEN_ERROR);
         // TODO replace with more specific error
         return SCPI_ERROR_MASS_STORAGE_ERROR;
     }
 
-    bool result = file.truncate(0);
-    file.close();
-    if (!result) {
-        event_queue::pushEvent(event_queue::EVENT_ERROR_DLOG_TRUNCATE_ERROR);
-        // TODO replace with more specific error
-        return SCPI_ERROR_MASS_STORAGE_ERROR;
-    }
+    g_fileIsOpen = true;
+    g_fileWritePending = false;
+    g_syncRequested = false;
+
+    // index of the previous recording is not valid anymore
+    dlog_view::deleteIndexFile(g_parameters.filePath);
 
     return SCPI_RES_OK;
 }
 
+static void fileClose() {
+    if (g_fileIsOpen) {
+        g_file.close();
+        g_fileIsOpen = false;
+    }
+}
+
+static void fileWriteError(int16_t eventId) {
+    event_queue::pushEvent(eventId);
+    abort();
+}
+
+static bool writeCompressedBlock(bool full) {
+    uint32_t length = g_blockEncoder.finish();
+    if (full) {
+        memset(DLOG_BLOCK_BUFFER + length, 0, dlog_codec::BLOCK_SIZE - length);
+        length = dlog_codec::BLOCK_SIZE;
+    }
+
+    // last block is written every time file is synced, so it can be rewritten more than once
+    return g_file.seek(g_recording.dataOffset + g_blockIndex * dlog_codec::BLOCK_SIZE) &&
+        g_file.write(DLOG_BLOCK_BUFFER, length) == length;
+}
+
+static bool writeCompressed(bool sync) {
+    // file header is not compressed
+    uint32_t readIndex = g_ring.getReadIndex();
+    if (readIndex < g_recording.dataOffset) {
+        const uint8_t *data;
+        uint32_t length = MIN(g_ring.peek(data), g_recording.dataOffset - readIndex);
+        if (
+            !g_file.seek(readIndex) ||
+            g_file.write(data, length) != length
+        ) {
+            return false;
+        }
+        g_ring.commit(length);
+    }
+
+    uint32_t rowSize = g_recording.parameters.numYAxes * sizeof(float);
+    float row[dlog_view::MAX_NUM_OF_Y_AXES];
+
+    while (g_ring.getReadIndex() >= g_recording.dataOffset && g_ring.getAvailable() >= rowSize) {
+        g_ring.copyOut(g_ring.getReadIndex(), (uint8_t *)row, rowSize);
+
+        if (!g_blockEncoder.addRow(row)) {
+            if (!writeCompressedBlock(true)) {
+                return false;
+            }
+
+            g_blockEncoder.start(DLOG_BLOCK_BUFFER, g_recording.parameters.numYAxes, g_blockEncoder.getFirstRow() + g_blockEncoder.getNumRows());
+            g_blockIndex++;
+
+            // row always fits into the empty block
+            g_blockEncoder.addRow(row);
+        }
+
+        g_ring.commit(rowSize);
+    }
+
+    if (sync && g_blockEncoder.getNumRows() > 0) {
+        return writeCompressedBlock(false);
+    }
+
+    return true;
+}
+
 void fileWrite() {
-    if (g_state != STATE_EXECUTING) {
+    g_fileWritePending = false;
+
+    if (g_state != STATE_EXECUTING || !g_fileIsOpen) {
         return;
     }
 
-    auto saveUpToBufferIndex = g_saveUpToBufferIndex;
-    size_t length = saveUpToBufferIndex - g_lastSavedBufferIndex;
-    if (length > 0) {
-        File file;
-        if (!file.open(g_recording.parameters.filePath, FILE_OPEN_APPEND | FILE_WRITE)) {
-            event_queue::pushEvent(event_queue::EVENT_ERROR_DLOG_FILE_REOPEN_ERROR);
-            abort();
-            return;
-        }
+    if (!sd_card::isMounted(nullptr)) {
+        fileWriteError(event_queue::EVENT_ERROR_DLOG_WRITE_ERROR);
+        return;
+    }
 
-        int i = g_lastSavedBufferIndex % DLOG_RECORD_BUFFER_SIZE;
-        int j = saveUpToBufferIndex % DLOG_RECORD_BUFFER_SIZE;
+    bool sync = g_syncRequested.exchange(false);
 
-        size_t written;
-        if (i < j || j == 0) {
-            written = file.write(DLOG_RECORD_BUFFER + i, length);
-        } else {
-            written = file.write(DLOG_RECORD_BUFFER + i, DLOG_RECORD_BUFFER_SIZE - i) + file.write(DLOG_RECORD_BUFFER, j);
+    if (g_recording.parameters.compression) {
+        // rows are compressed into the DLOG_BLOCK_BUFFER and written when block is full or on sync
+        if (!writeCompressed(sync)) {
+            fileWriteError(event_queue::EVENT_ERROR_DLOG_WRITE_ERROR);
+            return;
+        }
+    } else {
+        uint32_t available = g_ring.getAvailable();
+
+        if (!sync) {
+            // Write only whole chunks, so that file position stays aligned to the chunk size and
+            // FatFs can transfer the sectors directly from the buffer. The rest is written later.
+            int32_t availableInChunks = (int32_t)available - (int32_t)((g_ring.getReadIndex() + available) % CHUNK_SIZE);
+            if (availableInChunks <= 0) {
+                available = 0;
+            } else {
+                available = (uint32_t)availableInChunks;
+            }
         }
 
-        g_lastSavedBufferIndex = saveUpToBufferIndex;
+        // if recording is behind, write in larger chunks (up to MAX_WRITE_SIZE)
+        while (available > 0) {
+            const uint8_t *data;
+            uint32_t length = MIN(g_ring.peek(data), MIN(available, MAX_WRITE_SIZE));
 
-        file.close();
+            if (g_file.write(data, length) != length) {
+                fileWriteError(event_queue::EVENT_ERROR_DLOG_WRITE_ERROR);
+                return;
+            }
 
-        if (written != length) {
-            event_queue::pushEvent(event_queue::EVENT_ERROR_DLOG_WRITE_ERROR);
-            abort();
+            g_ring.commit(length);
+            available -= length;
         }
     }
+
+    // PSU thread couldn't write the data because ring was full
+    if (g_bufferOverflow) {
+        fileWriteError(event_queue::EVENT_ERROR_DLOG_BUFFER_OVERFLOW_ERROR);
+        return;
+    }
+
+    if (sync) {
+        g_file.sync();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 static void flushData() {
     if (osThreadGetId() != g_scpiTaskHandle) {
-        osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_TYPE_DLOG_FILE_WRITE, 0), osWaitForever);
+        // there is no need to queue another message if previous one is not processed yet
+        if (!g_fileWritePending.exchange(true)) {
+            osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_TYPE_DLOG_FILE_WRITE, 0), osWaitForever);
+        }
     } else {
         fileWrite();
     }
@@ -191,34 +391,60 @@ static void flushData() {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-static void writeUint8(uint8_t value) {
-    *(DLOG_RECORD_BUFFER + (g_bufferIndex % DLOG_RECORD_BUFFER_SIZE)) = value;
+// Copies data into the ring buffer, it is published to the SCPI thread in CHUNK_SIZE parts.
+static void writeBytes(const void *data, uint32_t length) {
+    if (g_bufferOverflow) {
+        return;
+    }
 
-    g_bufferIndex++;
+    if (!g_ring.write((const uint8_t *)data, length)) {
+        // nothing is written after this, so there are no missing or torn rows in the file
+        g_bufferOverflow = true;
+        flushData();
+        return;
+    }
+
+    g_fileLength += length;
 
-    if (g_state == STATE_EXECUTING && (g_bufferIndex - g_saveUpToBufferIndex) >= CHUNK_SIZE) {
-        g_lastSyncTickCount = micros();
-        g_saveUpToBufferIndex = g_bufferIndex;
+    if (g_state == STATE_EXECUTING && g_ring.getNumUnpublished() >= CHUNK_SIZE) {
+        g_ring.publish();
         flushData();
     }
+}
 
-    ++g_fileLength;
+static void publishData() {
+    g_ring.publish();
+    flushData();
+}
+
+static void writeUint8(uint8_t value) {
+    writeBytes(&value, 1);
 }
 
 static void writeUint16(uint16_t value) {
-    writeUint8(value & 0xFF);
-    writeUint8((value >> 8) & 0xFF);
+    uint8_t bytes[2] = {
+        (uint8_t)(value & 0xFF),
+        (uint8_t)((value >> 8) & 0xFF)
+    };
+    writeBytes(bytes, sizeof(bytes));
 }
 
 static void writeUint32(uint32_t value) {
-    writeUint8(value & 0xFF);
-    writeUint8((value >> 8) & 0xFF);
-    writeUint8((value >> 16) & 0xFF);
-    writeUint8(value >> 24);
+    uint8_t bytes[4] = {
+        (uint8_t)(value & 0xFF),
+        (uint8_t)((value >> 8) & 0xFF),
+        (uint8_t)((value >> 16) & 0xFF),
+        (uint8_t)(value >> 24)
+    };
+    writeBytes(bytes, sizeof(bytes));
 }
 
-static void writeFloat(float value) {
-    writeUint32(*((uint32_t *)&value));
+// Row values are stored as little endian float's, same as in memory on all supported platforms,
+// so the whole row is written with a single writeBytes call.
+static void writeRow(const float *values, uint32_t numValues) {
+    writeBytes(values, numValues * sizeof(float));
+    updateRangeChunk(values, numValues);
+    ++g_recording.size;
 }
 
 static void writeUint8Field(uint8_t id, uint8_t value) {
@@ -250,31 +476,29 @@ static void writeUint16FieldWithIndex(uint8_t id, uint16_t value, uint8_t index)
 static void writeFloatField(uint8_t id, float value) {
     writeUint16(sizeof(uint16_t) + sizeof(uint8_t) + sizeof(float));
     writeUint8(id);
-    writeFloat(value);
+    writeUint32(*((uint32_t *)&value));
 }
 
 static void writeFloatFieldWithIndex(uint8_t id, float value, uint8_t index) {
     writeUint16(sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(float));
     writeUint8(id);
     writeUint8(index);
-    writeFloat(value);
+    writeUint32(*((uint32_t *)&value));
 }
 
 static void writeStringField(uint8_t id, const char *str) {
-    writeUint16(sizeof(uint16_t) + sizeof(uint8_t) + (uint16_t)strlen(str));
+    uint16_t length = (uint16_t)strlen(str);
+    writeUint16(sizeof(uint16_t) + sizeof(uint8_t) + length);
     writeUint8(id);
-    while (*str) {
-        writeUint8(*str++);
-    }
+    writeBytes(str, length);
 }
 
 static void writeStringFieldWithIndex(uint8_t id, const char *str, uint8_t index) {
-    writeUint16(sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint8_t) + (uint16_t)strlen(str));
+    uint16_t length = (uint16_t)strlen(str);
+    writeUint16(sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint8_t) + length);
     writeUint8(id);
     writeUint8(index);
-    while (*str) {
-        writeUint8(*str++);
-    }
+    writeBytes(str, length);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -288,12 +512,22 @@ static void initRecordingStart() {
     g_currentTime = 0;
     g_nextTime = 0;
     g_fileLength = 0;
-    g_bufferIndex = 0;
-    g_lastSavedBufferIndex = 0;
-    g_saveUpToBufferIndex = 0;
+    g_ring.init(DLOG_RECORD_BUFFER, DLOG_RECORD_BUFFER_SIZE);
+    g_bufferOverflow = false;
 
     memcpy(&g_recording.parameters, &g_parameters, sizeof(dlog_view::Parameters));
 
+    memset(&g_statistics, 0, sizeof(g_statistics));
+    g_statistics.minInterval = 0xFFFFFFFF;
+    g_statistics.binWidth = MAX((uint32_t)(g_recording.parameters.period * 1E6f / Statistics::NUM_HISTOGRAM_BINS_PER_PERIOD), 1);
+    g_sampleTaken = false;
+
+    if (g_recording.parameters.deadband.enabled) {
+        // repeated rows are encoded with one bit per value only in the compressed format
+        g_recording.parameters.compression = true;
+        g_deadbandRowValid = false;
+    }
+
     g_recording.size = 0;
     g_recording.pageSize = 480;
 
@@ -307,15 +541,21 @@ static void initRecordingStart() {
     dlog_view::initDlogValues(g_recording);
 
     g_recording.getValue = getValue;
+    g_recording.getRange = getRange;
+
+    if (g_recording.parameters.compression) {
+        g_blockEncoder.start(DLOG_BLOCK_BUFFER, g_recording.parameters.numYAxes, 0);
+        g_blockIndex = 0;
+    }
 }
 
 static void writeFileHeaderAndMetaFields() {
     // header
     writeUint32(dlog_view::MAGIC1);
     writeUint32(dlog_view::MAGIC2);
-    writeUint16(dlog_view::VERSION2);
+    writeUint16(g_recording.parameters.compression ? dlog_view::VERSION3 : dlog_view::VERSION2);
     writeUint16(g_recording.parameters.numYAxes);
-    uint32_t savedBufferIndex = g_bufferIndex;
+    uint32_t dataOffsetIndex = g_ring.getWriteIndex();
     writeUint32(0);
 
     // meta fields
@@ -378,11 +618,19 @@ static void writeFileHeaderAndMetaFields() {
 
     writeUint16(0); // end of meta fields section
 
-    // write beginning of data offset
-    g_recording.dataOffset = 4 * ((g_bufferIndex + 3) / 4);
-    g_bufferIndex = savedBufferIndex;
-    writeUint32(g_recording.dataOffset);
-    g_bufferIndex = g_recording.dataOffset;
+    // data starts at 4 bytes boundary
+    static const uint8_t padding[3] = { 0, 0, 0 };
+    writeBytes(padding, (4 - g_ring.getWriteIndex() % 4) % 4);
+
+    // write beginning of data offset, header is not published yet so it can be changed
+    g_recording.dataOffset = g_ring.getWriteIndex();
+    uint8_t dataOffset[4] = {
+        (uint8_t)(g_recording.dataOffset & 0xFF),
+        (uint8_t)((g_recording.dataOffset >> 8) & 0xFF),
+        (uint8_t)((g_recording.dataOffset >> 16) & 0xFF),
+        (uint8_t)(g_recording.dataOffset >> 24)
+    };
+    g_ring.rewrite(dataOffsetIndex, dataOffset, sizeof(dataOffset));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -399,6 +647,140 @@ static void setState(State newState) {
     }
 }
 
+static uint32_t fillRow(float *row, float timestamp) {
+    uint32_t numValues = 0;
+
+    for (int i = 0; i < CH_NUM; ++i) {
+        Channel &channel = Channel::get(i);
+
+        float uMon = 0;
+        float iMon = 0;
+
+        if (g_recording.parameters.logVoltage[i]) {
+            uMon = channel_dispatcher::getUMonLast(channel);
+            row[numValues++] = uMon;
+        }
+
+        if (g_recording.parameters.logCurrent[i]) {
+            iMon = channel_dispatcher::getIMonLast(channel);
+            row[numValues++] = iMon;
+        }
+
+        if (g_recording.parameters.logPower[i]) {
+            if (!g_recording.parameters.logVoltage[i]) {
+                uMon = channel_dispatcher::getUMonLast(channel);
+            }
+            if (!g_recording.parameters.logCurrent[i]) {
+                iMon = channel_dispatcher::getIMonLast(channel);
+            }
+            row[numValues++] = uMon * iMon;
+        }
+    }
+
+    if (g_recording.parameters.logTimestamp) {
+        row[numValues++] = timestamp;
+    }
+
+    return numValues;
+}
+
+#if !defined(EEZ_PLATFORM_SIMULATOR)
+static uint32_t fillMissedRow(float *row) {
+    uint32_t numValues = 0;
+
+    for (int i = 0; i < CH_NUM; ++i) {
+        if (g_recording.parameters.logVoltage[i]) {
+            row[numValues++] = NAN;
+        }
+        if (g_recording.parameters.logCurrent[i]) {
+            row[numValues++] = NAN;
+        }
+        if (g_recording.parameters.logPower[i]) {
+            row[numValues++] = NAN;
+        }
+    }
+
+    if (g_recording.parameters.logTimestamp) {
+        row[numValues++] = NAN;
+    }
+
+    return numValues;
+}
+#endif
+
+// time elapsed from the nominal time of the sample that is currently written
+static float getTimestamp() {
+    return (float)(g_currentTime - (g_iSample - 1) * (double)g_recording.parameters.period);
+}
+
+static bool isOutsideDeadband(float value, float lastValue) {
+    if (isNaN(lastValue)) {
+        return !isNaN(value);
+    }
+
+    float diff = fabsf(value - lastValue);
+
+    const dlog_view::Deadband &deadband = g_recording.parameters.deadband;
+    if (deadband.absolute > 0 && diff > deadband.absolute) {
+        return true;
+    }
+    if (deadband.relative > 0 && diff > deadband.relative * fabsf(lastValue) / 100.0f) {
+        return true;
+    }
+    return deadband.absolute <= 0 && deadband.relative <= 0 && diff > 0;
+}
+
+// replaces row with the last written row if none of the U/I/P values left the deadband
+static void applyDeadband(float *row, uint32_t numValues) {
+    bool changed = !g_deadbandRowValid || g_currentTime - g_deadbandRowTime >= g_recording.parameters.deadband.maxInterval;
+
+    // timestamp column is not checked
+    uint32_t numCheckedValues = g_recording.parameters.logTimestamp ? numValues - 1 : numValues;
+    for (uint32_t i = 0; !changed && i < numCheckedValues; i++) {
+        changed = isOutsideDeadband(row[i], g_deadbandRow[i]);
+    }
+
+    if (changed) {
+        memcpy(g_deadbandRow, row, numValues * sizeof(float));
+        g_deadbandRowValid = true;
+        g_deadbandRowTime = g_currentTime;
+    } else {
+        memcpy(row, g_deadbandRow, numValues * sizeof(float));
+    }
+}
+
+static void writeSample(float *row) {
+    uint32_t numValues = fillRow(row, getTimestamp());
+    if (g_recording.parameters.deadband.enabled) {
+        applyDeadband(row, numValues);
+    }
+    writeRow(row, numValues);
+}
+
+static void updateStatistics(uint32_t tickCount) {
+    if (g_sampleTaken) {
+        uint32_t interval = tickCount - g_lastSampleTickCount;
+
+        g_statistics.numIntervals++;
+        if (interval < g_statistics.minInterval) {
+            g_statistics.minInterval = interval;
+        }
+        if (interval > g_statistics.maxInterval) {
+            g_statistics.maxInterval = interval;
+        }
+        g_statistics.sumIntervals += interval;
+
+        uint32_t binIndex = interval / g_statistics.binWidth;
+        if (binIndex >= Statistics::NUM_HISTOGRAM_BINS) {
+            binIndex = Statistics::NUM_HISTOGRAM_BINS - 1;
+        }
+        g_statistics.histogram[binIndex]++;
+    }
+
+    g_sampleTaken = true;
+    g_lastSampleTickCount = tickCount;
+}
+
 static void log(uint32_t tickCount) {
     g_micros += tickCount - g_lastTickCount;
     g_lastTickCount = tickCount;
@@ -415,6 +797,8 @@ static void log(uint32_t tickCount) {
     }
 
     if (g_currentTime >= g_nextTime) {
+        float row[dlog_view::MAX_NUM_OF_Y_AXES];
+
         while (1) {
             g_nextTime = ++g_iSample * g_recording.parameters.period;
             if (g_currentTime < g_nextTime || g_nextTime > g_recording.parameters.time) {
@@ -422,81 +806,18 @@ static void log(uint32_t tickCount) {
             }
 
 #if defined(EEZ_PLATFORM_SIMULATOR)
-            for (int i = 0; i < CH_NUM; ++i) {
-                Channel &channel = Channel::get(i);
-
-                float uMon = 0;
-                float iMon = 0;
-
-                if (g_recording.parameters.logVoltage[i]) {
-                    uMon = channel_dispatcher::getUMonLast(channel);
-                    writeFloat(uMon);
-                }
-
-                if (g_recording.parameters.logCurrent[i]) {
-                    iMon = channel_dispatcher::getIMonLast(channel);
-                    writeFloat(iMon);
-                }
-
-                if (g_recording.parameters.logPower[i]) {
-                    if (!g_recording.parameters.logVoltage[i]) {
-                        uMon = channel_dispatcher::getUMonLast(channel);
-                    }
-                    if (!g_recording.parameters.logCurrent[i]) {
-                        iMon = channel_dispatcher::getIMonLast(channel);
-                    }
-                    writeFloat(uMon * iMon);
-                }
-            }
-
-            ++g_recording.size;
+            writeSample(row);
 #else
             // we missed a sample, write NAN's
-            for (int i = 0; i < CH_NUM; ++i) {
-                if (g_recording.parameters.logVoltage[i]) {
-                    writeFloat(NAN);
-                }
-                if (g_recording.parameters.logCurrent[i]) {
-                    writeFloat(NAN);
-                }
-                if (g_recording.parameters.logPower[i]) {
-                    writeFloat(NAN);
-                }
-            }
-
-            ++g_recording.size;
+            writeRow(row, fillMissedRow(row));
+            g_deadbandRowValid = false;
 #endif
+            g_statistics.numMissedSamples++;
         }
 
         // write sample
-        for (int i = 0; i < CH_NUM; ++i) {
-            Channel &channel = Channel::get(i);
-
-            float uMon = 0;
-            float iMon = 0;
-
-            if (g_recording.parameters.logVoltage[i]) {
-                uMon = channel_dispatcher::getUMonLast(channel);
-                writeFloat(uMon);
-            }
-
-            if (g_recording.parameters.logCurrent[i]) {
-                iMon = channel_dispatcher::getIMonLast(channel);
-                writeFloat(iMon);
-            }
-
-            if (g_recording.parameters.logPower[i]) {
-                if (!g_recording.parameters.logVoltage[i]) {
-                    uMon = channel_dispatcher::getUMonLast(channel);
-                }
-                if (!g_recording.parameters.logCurrent[i]) {
-                    iMon = channel_dispatcher::getIMonLast(channel);
-                }
-                writeFloat(uMon * iMon);
-            }
-        }
-        
-        ++g_recording.size;
+        writeSample(row);
+        updateStatistics(tickCount);
 
         if (g_nextTime > g_recording.parameters.time) {
             stateTransition(EVENT_FINISH);
@@ -504,8 +825,8 @@ static void log(uint32_t tickCount) {
             int32_t diff = tickCount - g_lastSyncTickCount;
             if (diff > CONF_DLOG_SYNC_FILE_TIME * 1000000L) {
                 g_lastSyncTickCount = tickCount;
-                g_saveUpToBufferIndex = g_bufferIndex;
-                flushData();
+                g_syncRequested = true;
+                publishData();
             }
         }
     }
@@ -519,7 +840,7 @@ static int doStartImmediately() {
         return err;
     }
 
-    err = fileTruncate();
+    err = fileOpen();
     if (err != SCPI_RES_OK) {
         return err;
     }
@@ -559,11 +880,13 @@ static void resetParameters() {
     g_parameters.period = PERIOD_DEFAULT;
     g_parameters.time = TIME_DEFAULT;
     g_parameters.triggerSource = trigger::SOURCE_IMMEDIATE;
+    g_parameters.deadband.maxInterval = DEADBAND_MAX_INTERVAL_DEFAULT;
 }
 
 static void doFinish() {
-    g_saveUpToBufferIndex = g_bufferIndex;
-    flushData();
+    g_syncRequested = true;
+    publishData();
+    fileClose();
     onSdCardFileChangeHook(g_parameters.filePath);
     resetParameters();
     setState(STATE_IDLE);
@@ -653,6 +976,7 @@ void stateTransition(int event, int* perr) {
             doFinish();
             err = SCPI_RES_OK;
         } else if (event == EVENT_ABORT || event == EVENT_RESET) {
+            fileClose();
             onSdCardFileChangeHook(g_parameters.filePath);
             resetParameters();
             setState(STATE_IDLE);
@@ -717,11 +1041,32 @@ void tick(uint32_t tickCount) {
 
 void log(float *values) {
     if (g_state == STATE_EXECUTING) {
-        for (int yAxisIndex = 0; yAxisIndex < dlog_record::g_recording.parameters.numYAxes; yAxisIndex++) {
-            writeFloat(values[yAxisIndex]);
+        writeRow(values, g_recording.parameters.numYAxes);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void getStatistics(Statistics &statistics) {
+    memcpy(&statistics, &g_statistics, sizeof(Statistics));
+}
+
+float getIntervalPercentile(const Statistics &statistics, float percentage) {
+    if (statistics.numIntervals == 0) {
+        return 0;
+    }
+
+    uint32_t n = (uint32_t)ceilf(statistics.numIntervals * percentage / 100.0f);
+
+    uint32_t count = 0;
+    for (int binIndex = 0; binIndex < Statistics::NUM_HISTOGRAM_BINS - 1; binIndex++) {
+        count += statistics.histogram[binIndex];
+        if (count >= n) {
+            return MIN((binIndex + 1) * statistics.binWidth, statistics.maxInterval) * 1E-6f;
         }
-        ++g_recording.size;
     }
+
+    return statistics.maxInterval * 1E-6f;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +33,10 @@ static const float TIME_MIN = 1.0f;
 static const float TIME_MAX = 86400000.0f;
 static const float TIME_DEFAULT = 60.0f;
 
+static const float DEADBAND_MAX_INTERVAL_MIN = PERIOD_MIN;
+static const float DEADBAND_MAX_INTERVAL_MAX = TIME_MAX;
+static const float DEADBAND_MAX_INTERVAL_DEFAULT = 10.0f;
+
 extern double g_currentTime;
 extern uint32_t g_fileLength;
 extern dlog_view::Parameters g_parameters;
@@ -45,6 +49,20 @@ enum State {
     STATE_EXECUTING
 };
 
+// Intervals between the samples taken by the PSU thread during the last recording
+struct Statistics {
+    static const int NUM_HISTOGRAM_BINS = 32;
+    static const int NUM_HISTOGRAM_BINS_PER_PERIOD = 8;
+
+    uint32_t numIntervals;
+    uint32_t numMissedSamples;
+    uint32_t minInterval; // in microseconds
+    uint32_t maxInterval; // in microseconds
+    uint64_t sumIntervals; // in microseconds
+    uint32_t binWidth; // in microseconds, period / NUM_HISTOGRAM_BINS_PER_PERIOD
+    uint32_t histogram[NUM_HISTOGRAM_BINS]; // last bin also counts all the longer intervals
+};
+
 extern State g_state;
 extern bool g_inStateTransition;
 extern bool g_traceInitiated;
@@ -70,6 +88,11 @@ void tick(uint32_t tick_usec);
 void log(float *values);
 
 void fileWrite();
+
+void getStatistics(Statistics &statistics);
+// upper bound of the interval (in seconds) under which is given percentage of the intervals
+float getIntervalPercentile(const Statistics &statistics, float percentage);
+
 void stateTransition(int event, int *perr = nullptr);
 
 const char *getLatestFilePath();
@@ -19,8 +19,18 @@
 #include <string.h>
 #include <stdio.h>
 #include <float.h>
+#include <math.h>
 #include <assert.h>
 
+#include <atomic>
+
+#if defined(EEZ_PLATFORM_SIMULATOR) && !defined(EEZ_PLATFORM_SIMULATOR_EMSCRIPTEN)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#define DLOG_VIEW_LOAD_WORKERS
+#endif
+
 #include <eez/system.h>
 
 #include <eez/scpi/scpi.h>
@@ -28,8 +38,13 @@
 #include <eez/modules/psu/psu.h>
 #include <eez/modules/psu/channel_dispatcher.h>
 #include <eez/modules/psu/dlog_view.h>
+#include <eez/modules/psu/dlog_view_min_max.h>
 #include <eez/modules/psu/dlog_record.h>
+#include <eez/modules/psu/dlog_codec.h>
+#include <eez/modules/psu/dlog_view_storage.h>
+#include <eez/modules/psu/debug.h>
 #include <eez/modules/psu/scpi/psu.h>
+#include <eez/modules/psu/sd_card.h>
 #include <eez/modules/psu/serial_psu.h>
 #if OPTION_ETHERNET
 #include <eez/modules/psu/ethernet.h>
@@ -56,12 +71,6 @@ bool g_showLabels = false;
 char g_filePath[MAX_PATH_LENGTH + 1];
 Recording g_recording;
 
-struct CacheBlock {
-    unsigned valid: 1;
-    uint32_t loadedValues;
-    uint32_t startAddress;
-};
-
 struct BlockElement {
     float min;
     float max;
@@ -69,17 +78,127 @@ struct BlockElement {
 
 static const uint32_t NUM_ELEMENTS_PER_BLOCKS = 480 * MAX_NUM_OF_Y_VALUES;
 static const uint32_t BLOCK_SIZE = NUM_ELEMENTS_PER_BLOCKS * sizeof(BlockElement);
-static const uint32_t NUM_BLOCKS = FILE_VIEW_BUFFER_SIZE / (BLOCK_SIZE + sizeof(CacheBlock));
+
+// every cache block keeps min/max per column for each segment, used by scaleToFit
+static const uint32_t NUM_SEGMENTS_PER_BLOCK = 16;
+static const uint32_t NUM_ELEMENTS_PER_SEGMENT = NUM_ELEMENTS_PER_BLOCKS / NUM_SEGMENTS_PER_BLOCK;
+
+// Cache blocks are identified by the start address and the zoom (load scale) for which they are loaded,
+// so blocks from the previous zoom are not thrown away and they are evicted only when the space is needed.
+struct CacheBlock {
+    unsigned valid: 1;
+    std::atomic<uint32_t> loadedValues; // elements below are loaded, read by the GUI thread while loading
+    uint32_t startAddress;
+    float loadScale;
+    uint32_t lastUsed;
+    BlockElement segmentRanges[NUM_SEGMENTS_PER_BLOCK][MAX_NUM_OF_Y_VALUES];
+};
+
+// last part of the FILE_VIEW_BUFFER is used while building min/max index
+static const uint32_t INDEX_LEVEL_BUFFER_SIZE = 2 * 1024;
+static const uint32_t INDEX_READ_BUFFER_SIZE = 32 * 1024;
+static const int MAX_INDEX_LEVELS = 14;
+static const uint32_t INDEX_BUFFER_SIZE = MAX_INDEX_LEVELS * INDEX_LEVEL_BUFFER_SIZE + INDEX_READ_BUFFER_SIZE;
+static uint8_t * const INDEX_BUFFER = FILE_VIEW_BUFFER + FILE_VIEW_BUFFER_SIZE - INDEX_BUFFER_SIZE;
+
+// compressed data block (VERSION3) that is decoded by the SD card thread is stored just before the index buffer
+static uint8_t * const DATA_BLOCK_BUFFER = INDEX_BUFFER - dlog_codec::BLOCK_SIZE;
+
+static const uint32_t NUM_BLOCKS = (FILE_VIEW_BUFFER_SIZE - INDEX_BUFFER_SIZE - dlog_codec::BLOCK_SIZE) / (BLOCK_SIZE + sizeof(CacheBlock));
 
 CacheBlock *g_cacheBlocks = (CacheBlock *)FILE_VIEW_BUFFER;
 
-static bool g_isLoading;
-static bool g_interruptLoading;
+static std::atomic<bool> g_isLoading;
+static std::atomic<bool> g_interruptLoading;
 static uint32_t g_blockIndexToLoad;
 static float g_loadScale;
-static bool g_refreshed;
+static std::atomic<bool> g_refreshed;
 static bool g_wasExecuting;
 
+static uint32_t g_cacheBlockIndexHint;
+static uint32_t g_cacheUseCounter;
+
+// read-ahead is done in the scroll direction and more blocks are read ahead if scrolling is faster
+static const uint32_t MAX_READ_AHEAD_BLOCKS = 4;
+static const float READ_AHEAD_TIME = 1.0f; // in seconds
+static const uint32_t SCROLL_IDLE_TIME = 500; // in milliseconds
+static int g_scrollDirection = 1;
+static float g_scrollVelocity; // in rows per second
+static uint32_t g_lastScrollTickCount;
+
+static uint32_t g_numDataBlocks;
+
+// Reads samples from the data file. Reader keeps the state of the compressed block decoder,
+// so every thread that reads the file must use its own reader.
+struct DataReader {
+    DataReader(DataFile &file_, uint8_t *dataBlockBuffer_)
+        : file(file_), dataBlockBuffer(dataBlockBuffer_), dataBlockIndex(-1)
+    {
+    }
+
+    DataFile &file;
+    uint8_t *dataBlockBuffer; // used if data block can't be decoded directly from the file
+    int32_t dataBlockIndex; // index of the currently decoded data block or -1
+    uint32_t dataBlockLength;
+    const uint8_t *dataBlock;
+    dlog_codec::BlockDecoder decoder;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* DLOG Index File Format
+
+Index is stored next to the dlog file, file name is the dlog file name with INDEX_FILE_EXT appended.
+It is a min/max pyramid: every element of the level 0 holds min and max of INDEX_BASE_FACTOR
+consecutive samples of one column and every element of the level N holds min and max
+of INDEX_LEVEL_FACTOR consecutive elements of the level N - 1. Index is built lazily, in slices
+on the SCPI thread, after dlog file is opened for viewing. Once built, any zoom level at which
+the block element covers INDEX_BASE_FACTOR or more samples is loaded from the index.
+
+OFFSET                 TYPE        DESCRIPTION
+----------------------------------------------------------------------
+0                      IndexHeader
+levelOffsets[N]        BlockElement levelNumRows[N] * numElementsPerRow elements of the level N
+*/
+
+static const char *INDEX_FILE_EXT = ".idx";
+static const uint32_t INDEX_MAGIC = 0x58444C44;
+static const uint16_t INDEX_VERSION = 1;
+static const uint32_t INDEX_BASE_FACTOR = 16;
+static const uint32_t INDEX_LEVEL_FACTOR = 4;
+static const uint32_t INDEX_BYTES_PER_SLICE = 256 * 1024;
+
+struct IndexHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t numElementsPerRow;
+    uint32_t dataOffset;
+    uint32_t fileSize;
+    uint32_t numSamples;
+    uint32_t numLevels;
+    uint32_t levelOffsets[MAX_INDEX_LEVELS];
+    uint32_t levelNumRows[MAX_INDEX_LEVELS];
+};
+
+enum IndexState {
+    INDEX_STATE_NONE,
+    INDEX_STATE_BUILDING,
+    INDEX_STATE_READY
+};
+
+struct IndexLevelBuilder {
+    BlockElement elements[MAX_NUM_OF_Y_VALUES];
+    uint32_t count;
+    uint32_t numBufferedRows;
+    uint32_t numWrittenRows;
+};
+
+static IndexState g_indexState;
+static bool g_indexBuildPending;
+static IndexHeader g_indexHeader;
+static uint32_t g_indexBuildSample;
+static IndexLevelBuilder g_indexLevelBuilders[MAX_INDEX_LEVELS];
+
 State getState() {
     if (g_showLatest) {
         if (g_wasExecuting) {
@@ -140,92 +259,1083 @@ void invalidateAllBlocks() {
     }
 }
 
-void loadBlock() {
-    static const int NUM_VALUES_ROWS = 16;
-    float values[18 * NUM_VALUES_ROWS];
+// NaN is a gap in the recording and it is ignored
+inline void mergeBlockElement(BlockElement &dst, const BlockElement &src) {
+    if (isnan(dst.min) || src.min < dst.min) {
+        dst.min = src.min;
+    }
+    if (isnan(dst.max) || src.max > dst.max) {
+        dst.max = src.max;
+    }
+}
 
-    auto numSamplesPerValue = (unsigned)round(g_loadScale);
-    if (numSamplesPerValue > 0) {
-        File file;
-        if (file.open(g_filePath, FILE_OPEN_EXISTING | FILE_READ)) {
-            auto numElementsPerRow = getNumElementsPerRow();
+inline void setCacheBlockElement(uint32_t i, unsigned columnIndex, const BlockElement &element) {
+    getCacheBlock(g_blockIndexToLoad)[i] = element;
+    mergeBlockElement(g_cacheBlocks[g_blockIndexToLoad].segmentRanges[i / NUM_ELEMENTS_PER_SEGMENT][columnIndex], element);
+}
 
-            BlockElement *blockElements = getCacheBlock(g_blockIndexToLoad);
+static uint32_t getStartSample(uint32_t rowIndex) {
+    uint32_t numYAxes = g_recording.parameters.numYAxes;
+    auto offset = (uint32_t)roundf(rowIndex * g_loadScale * numYAxes);
+    return (offset + numYAxes - 1) / numYAxes;
+}
 
-            uint32_t totalBytesRead = 0;
+////////////////////////////////////////////////////////////////////////////////
 
-            uint32_t i = g_cacheBlocks[g_blockIndexToLoad].loadedValues;
-            while (i < NUM_ELEMENTS_PER_BLOCKS) {
-                auto offset = (uint32_t)roundf((g_blockIndexToLoad * NUM_ELEMENTS_PER_BLOCKS + i) / numElementsPerRow * g_loadScale * g_recording.parameters.numYAxes);
+static bool readDataBlockHeader(DataFile &file, uint32_t dataBlockIndex, dlog_codec::BlockHeader &header, Range *ranges) {
+    uint8_t buffer[dlog_codec::BLOCK_HEADER_SIZE + MAX_NUM_OF_Y_AXES * sizeof(Range)];
+    uint32_t length = dlog_codec::getBlockDataOffset(g_recording.parameters.numYAxes);
+    if (file.read(g_recording.dataOffset + dataBlockIndex * dlog_codec::BLOCK_SIZE, buffer, length) != length) {
+        return false;
+    }
+    return dlog_codec::readBlockHeader(buffer, g_recording.parameters.numYAxes, header, ranges);
+}
 
-                offset = g_recording.parameters.numYAxes *((offset + g_recording.parameters.numYAxes - 1) / g_recording.parameters.numYAxes);
+static bool loadDataBlock(DataReader &reader, uint32_t dataBlockIndex) {
+    if (reader.dataBlockIndex != (int32_t)dataBlockIndex) {
+        reader.dataBlockIndex = -1;
 
-                size_t filePosition = g_recording.dataOffset + offset * sizeof(float);
-                if (!file.seek(filePosition)) {
-                    i = NUM_ELEMENTS_PER_BLOCKS;
-                    goto closeFile;
-                }
+        uint32_t offset = g_recording.dataOffset + dataBlockIndex * dlog_codec::BLOCK_SIZE;
 
-                unsigned iStart = i;
+        // only the last block can be shorter
+        uint32_t length = offset < reader.file.size() ? MIN(reader.file.size() - offset, dlog_codec::BLOCK_SIZE) : 0;
+        if (length != dlog_codec::BLOCK_SIZE && dataBlockIndex != g_numDataBlocks - 1) {
+            return false;
+        }
 
-                for (unsigned j = 0; j < numSamplesPerValue; j++) {
-                    i = iStart;
+        // decode directly from the mapped file if possible
+        reader.dataBlock = reader.file.map(offset, length);
+        if (reader.dataBlock) {
+            reader.dataBlockLength = length;
+        } else {
+            reader.dataBlock = reader.dataBlockBuffer;
+            reader.dataBlockLength = reader.file.read(offset, reader.dataBlockBuffer, length);
+            if (reader.dataBlockLength != length) {
+                return false;
+            }
+        }
+    }
 
-                    auto valuesRow = j % NUM_VALUES_ROWS;
+    if (!reader.decoder.start(reader.dataBlock, reader.dataBlockLength, g_recording.parameters.numYAxes)) {
+        return false;
+    }
 
-                    if (valuesRow == 0) {
-                        if (g_interruptLoading) {
-                            i = NUM_ELEMENTS_PER_BLOCKS;
-                            goto closeFile;
-                        }
+    reader.dataBlockIndex = dataBlockIndex;
+    return true;
+}
 
-                        // read up to NUM_VALUES_ROWS
-                        uint32_t bytesToRead = MIN(NUM_VALUES_ROWS, numSamplesPerValue - j) * g_recording.parameters.numYAxes * sizeof(float);
-                        uint32_t bytesRead = file.read(values, bytesToRead);
-                        if (bytesToRead != bytesRead) {
-                            i = NUM_ELEMENTS_PER_BLOCKS;
-                            goto closeFile;
-                        }
+static bool findDataBlock(DataReader &reader, uint32_t rowIndex, uint32_t &dataBlockIndex) {
+    // sequential access is the most common, so check the decoded and the next block first
+    if (reader.dataBlockIndex != -1) {
+        const dlog_codec::BlockHeader &header = reader.decoder.getHeader();
+        if (rowIndex >= header.firstRow && rowIndex < header.firstRow + header.numRows) {
+            dataBlockIndex = reader.dataBlockIndex;
+            return true;
+        }
+        if (rowIndex == header.firstRow + header.numRows && (uint32_t)reader.dataBlockIndex + 1 < g_numDataBlocks) {
+            dataBlockIndex = reader.dataBlockIndex + 1;
+            return true;
+        }
+    }
 
-                        totalBytesRead += bytesRead;
-                    }
+    dlog_codec::BlockHeader header;
+    Range ranges[MAX_NUM_OF_Y_AXES];
+
+    uint32_t low = 0;
+    uint32_t high = g_numDataBlocks;
+    while (low < high) {
+        uint32_t middle = (low + high) / 2;
+        if (!readDataBlockHeader(reader.file, middle, header, ranges)) {
+            return false;
+        }
+        if (rowIndex < header.firstRow) {
+            high = middle;
+        } else if (rowIndex >= header.firstRow + header.numRows) {
+            low = middle + 1;
+        } else {
+            dataBlockIndex = middle;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool seekToRow(DataReader &reader, uint32_t rowIndex) {
+    uint32_t dataBlockIndex;
+    if (!findDataBlock(reader, rowIndex, dataBlockIndex)) {
+        return false;
+    }
+
+    if (reader.dataBlockIndex != (int32_t)dataBlockIndex || reader.decoder.getRowIndex() > rowIndex) {
+        if (!loadDataBlock(reader, dataBlockIndex)) {
+            return false;
+        }
+    }
 
-                    unsigned valuesOffset = valuesRow * g_recording.parameters.numYAxes;
+    return reader.decoder.skipRows(rowIndex - reader.decoder.getRowIndex());
+}
 
-                    for (unsigned k = 0; k < g_recording.parameters.numYAxes; k++) {
-                        if (k < numElementsPerRow) {
-                            BlockElement *blockElement = blockElements + i++;
+// reads numSamples rows starting from startSample, works for both raw and compressed data
+static bool readSamples(DataReader &reader, uint32_t startSample, uint32_t numSamples, float *values) {
+    uint32_t numYAxes = g_recording.parameters.numYAxes;
 
-                            float value = values[valuesOffset + k];
+    if (!g_recording.parameters.compression) {
+        uint32_t bytesToRead = numSamples * numYAxes * sizeof(float);
+        return reader.file.read(g_recording.dataOffset + startSample * numYAxes * sizeof(float), values, bytesToRead) == bytesToRead;
+    }
 
-                            if (j == 0) {
-                                blockElement->min = blockElement->max = value;
-                            } else if (value < blockElement->min) {
-                                blockElement->min = value;
-                            } else if (value > blockElement->max) {
-                                blockElement->max = value;
-                            }
-                        }
+    if (!seekToRow(reader, startSample)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numSamples; i++) {
+        if (!reader.decoder.readRow(values + i * numYAxes)) {
+            // continue in the next block
+            if (!seekToRow(reader, startSample + i) || !reader.decoder.readRow(values + i * numYAxes)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Returns numSamples rows starting from startSample. Raw data is returned directly from
+// the mapped file if possible, otherwise rows are read into values.
+static const float *getSamples(DataReader &reader, uint32_t startSample, uint32_t numSamples, float *values) {
+    if (!g_recording.parameters.compression) {
+        uint32_t sampleSize = g_recording.parameters.numYAxes * sizeof(float);
+        const uint8_t *data = reader.file.map(g_recording.dataOffset + startSample * sampleSize, numSamples * sampleSize);
+        if (data && ((uintptr_t)data % sizeof(float)) == 0) {
+            return (const float *)data;
+        }
+    }
+
+    return readSamples(reader, startSample, numSamples, values) ? values : nullptr;
+}
+
+// Gives the hint about the upcoming access to the samples from startSample to endSample.
+static void adviseSamples(DataReader &reader, uint32_t startSample, uint32_t endSample, DataFile::AccessPattern pattern) {
+    // hints are used only with the mapped file, so don't search for data blocks otherwise
+    if (!reader.file.isMapped() || startSample >= endSample) {
+        return;
+    }
+
+    uint32_t startOffset;
+    uint32_t endOffset;
+
+    if (!g_recording.parameters.compression) {
+        uint32_t sampleSize = g_recording.parameters.numYAxes * sizeof(float);
+        startOffset = g_recording.dataOffset + startSample * sampleSize;
+        endOffset = g_recording.dataOffset + endSample * sampleSize;
+    } else {
+        uint32_t startDataBlockIndex;
+        uint32_t endDataBlockIndex;
+        if (!findDataBlock(reader, startSample, startDataBlockIndex) || !findDataBlock(reader, endSample - 1, endDataBlockIndex)) {
+            return;
+        }
+        startOffset = g_recording.dataOffset + startDataBlockIndex * dlog_codec::BLOCK_SIZE;
+        endOffset = g_recording.dataOffset + (endDataBlockIndex + 1) * dlog_codec::BLOCK_SIZE;
+    }
+
+    reader.file.advise(startOffset, endOffset - startOffset, pattern);
+}
+
+// min and max of the first numElementsPerRow columns of numSamples rows starting from startSample
+static bool readMinMax(DataReader &reader, uint32_t startSample, uint32_t numSamples, BlockElement *elements) {
+    static const int NUM_VALUES_ROWS = 32;
+    float values[MAX_NUM_OF_Y_AXES * NUM_VALUES_ROWS];
+    float columns[MAX_NUM_OF_Y_VALUES * NUM_VALUES_ROWS];
+    float mins[MAX_NUM_OF_Y_VALUES];
+    float maxs[MAX_NUM_OF_Y_VALUES];
+
+    auto numElementsPerRow = getNumElementsPerRow();
+    uint32_t numYAxes = g_recording.parameters.numYAxes;
+
+    for (unsigned k = 0; k < numElementsPerRow; k++) {
+        mins[k] = INFINITY;
+        maxs[k] = -INFINITY;
+    }
+
+    uint32_t endSample = startSample + numSamples;
+    uint32_t sample = startSample;
+
+    while (sample < endSample) {
+        if (g_interruptLoading) {
+            return false;
+        }
+
+        uint32_t n = MIN(NUM_VALUES_ROWS, endSample - sample);
+
+        if (g_recording.parameters.compression) {
+            uint32_t dataBlockIndex;
+            if (!findDataBlock(reader, sample, dataBlockIndex)) {
+                return false;
+            }
+
+            dlog_codec::BlockHeader header;
+            Range ranges[MAX_NUM_OF_Y_AXES];
+            if (reader.dataBlockIndex == (int32_t)dataBlockIndex) {
+                header = reader.decoder.getHeader();
+                memcpy(ranges, reader.decoder.getRanges(), numYAxes * sizeof(Range));
+            } else if (!readDataBlockHeader(reader.file, dataBlockIndex, header, ranges)) {
+                return false;
+            }
+
+            uint32_t blockEndSample = header.firstRow + header.numRows;
+
+            if (sample == header.firstRow && blockEndSample <= endSample) {
+                // whole block is covered, use min/max from the block header without decompressing it
+                for (unsigned k = 0; k < numElementsPerRow; k++) {
+                    if (ranges[k].min < mins[k]) {
+                        mins[k] = ranges[k].min;
+                    }
+                    if (ranges[k].max > maxs[k]) {
+                        maxs[k] = ranges[k].max;
                     }
                 }
+                sample = blockEndSample;
+                continue;
+            }
+
+            n = MIN(n, blockEndSample - sample);
+        }
+
+        const float *rows = getSamples(reader, sample, n, values);
+        if (!rows) {
+            return false;
+        }
+
+        // transpose rows into columns, so every column is reduced from the contiguous memory
+        for (uint32_t j = 0; j < n; j++) {
+            for (unsigned k = 0; k < numElementsPerRow; k++) {
+                columns[k * NUM_VALUES_ROWS + j] = rows[j * numYAxes + k];
+            }
+        }
+
+        for (unsigned k = 0; k < numElementsPerRow; k++) {
+            reduceMinMax(columns + k * NUM_VALUES_ROWS, n, mins[k], maxs[k]);
+        }
+
+        sample += n;
+    }
+
+    for (unsigned k = 0; k < numElementsPerRow; k++) {
+        if (mins[k] <= maxs[k]) {
+            elements[k].min = mins[k];
+            elements[k].max = maxs[k];
+        } else {
+            // all values are NaN
+            elements[k].min = NAN;
+            elements[k].max = NAN;
+        }
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool getIndexFilePath(const char *filePath, char *indexFilePath) {
+    if (strlen(filePath) + strlen(INDEX_FILE_EXT) > MAX_PATH_LENGTH) {
+        return false;
+    }
+    strcpy(indexFilePath, filePath);
+    strcat(indexFilePath, INDEX_FILE_EXT);
+    return true;
+}
+
+void deleteIndexFile(const char *filePath) {
+    char indexFilePath[MAX_PATH_LENGTH + 1];
+    if (getIndexFilePath(filePath, indexFilePath)) {
+        int err;
+        sd_card::deleteFile(indexFilePath, &err);
+    }
+}
+
+static void openIndex(uint32_t fileSize) {
+    g_indexState = INDEX_STATE_NONE;
+    g_indexBuildPending = false;
+
+    if (g_recording.numSamples < 2 * INDEX_BASE_FACTOR) {
+        return;
+    }
+
+    char indexFilePath[MAX_PATH_LENGTH + 1];
+    if (!getIndexFilePath(g_filePath, indexFilePath)) {
+        return;
+    }
+
+    memset(&g_indexHeader, 0, sizeof(IndexHeader));
+    g_indexHeader.version = INDEX_VERSION;
+    g_indexHeader.numElementsPerRow = getNumElementsPerRow();
+    g_indexHeader.dataOffset = g_recording.dataOffset;
+    g_indexHeader.fileSize = fileSize;
+    g_indexHeader.numSamples = g_recording.numSamples;
+
+    uint32_t rowSize = g_indexHeader.numElementsPerRow * sizeof(BlockElement);
+    uint32_t levelOffset = 4 * ((sizeof(IndexHeader) + 3) / 4);
+    uint32_t factor = INDEX_BASE_FACTOR;
+    while (g_indexHeader.numLevels < MAX_INDEX_LEVELS) {
+        uint32_t numRows = (g_indexHeader.numSamples + factor - 1) / factor;
+        g_indexHeader.levelOffsets[g_indexHeader.numLevels] = levelOffset;
+        g_indexHeader.levelNumRows[g_indexHeader.numLevels] = numRows;
+        g_indexHeader.numLevels++;
+        levelOffset += numRows * rowSize;
+        if (numRows <= 1) {
+            break;
+        }
+        factor *= INDEX_LEVEL_FACTOR;
+    }
+
+    File indexFile;
+    if (indexFile.open(indexFilePath, FILE_OPEN_EXISTING | FILE_READ)) {
+        IndexHeader header;
+        if (indexFile.read(&header, sizeof(IndexHeader)) == sizeof(IndexHeader)) {
+            g_indexHeader.magic = INDEX_MAGIC;
+            if (memcmp(&header, &g_indexHeader, sizeof(IndexHeader)) == 0) {
+                g_indexState = INDEX_STATE_READY;
+            }
+        }
+    }
+    indexFile.close();
+
+    if (g_indexState != INDEX_STATE_READY) {
+        g_indexHeader.magic = 0;
+        g_indexBuildSample = 0;
+        memset(g_indexLevelBuilders, 0, sizeof(g_indexLevelBuilders));
+        g_indexState = INDEX_STATE_BUILDING;
+    }
+}
+
+static uint8_t *getIndexLevelBuffer(int levelIndex) {
+    return INDEX_BUFFER + levelIndex * INDEX_LEVEL_BUFFER_SIZE;
+}
+
+static bool flushIndexLevel(File &indexFile, int levelIndex) {
+    IndexLevelBuilder &level = g_indexLevelBuilders[levelIndex];
+    if (level.numBufferedRows > 0) {
+        uint32_t rowSize = g_indexHeader.numElementsPerRow * sizeof(BlockElement);
+        if (!indexFile.seek(g_indexHeader.levelOffsets[levelIndex] + level.numWrittenRows * rowSize)) {
+            return false;
+        }
+        size_t length = level.numBufferedRows * rowSize;
+        if (indexFile.write(getIndexLevelBuffer(levelIndex), length) != length) {
+            return false;
+        }
+        level.numWrittenRows += level.numBufferedRows;
+        level.numBufferedRows = 0;
+    }
+    return true;
+}
+
+static bool addToIndexLevel(File &indexFile, int levelIndex, const BlockElement *elements);
+
+static bool emitIndexLevelRow(File &indexFile, int levelIndex) {
+    IndexLevelBuilder &level = g_indexLevelBuilders[levelIndex];
+    uint32_t rowSize = g_indexHeader.numElementsPerRow * sizeof(BlockElement);
+
+    memcpy(getIndexLevelBuffer(levelIndex) + level.numBufferedRows * rowSize, level.elements, rowSize);
+    level.count = 0;
+
+    if (++level.numBufferedRows == INDEX_LEVEL_BUFFER_SIZE / rowSize) {
+        if (!flushIndexLevel(indexFile, levelIndex)) {
+            return false;
+        }
+    }
+
+    if (levelIndex + 1 < (int)g_indexHeader.numLevels) {
+        return addToIndexLevel(indexFile, levelIndex + 1, level.elements);
+    }
+
+    return true;
+}
+
+static bool addToIndexLevel(File &indexFile, int levelIndex, const BlockElement *elements) {
+    IndexLevelBuilder &level = g_indexLevelBuilders[levelIndex];
+
+    if (level.count == 0) {
+        memcpy(level.elements, elements, g_indexHeader.numElementsPerRow * sizeof(BlockElement));
+    } else {
+        for (unsigned k = 0; k < g_indexHeader.numElementsPerRow; k++) {
+            mergeBlockElement(level.elements[k], elements[k]);
+        }
+    }
+
+    if (++level.count == (levelIndex == 0 ? INDEX_BASE_FACTOR : INDEX_LEVEL_FACTOR)) {
+        return emitIndexLevelRow(indexFile, levelIndex);
+    }
+
+    return true;
+}
+
+static bool finishIndex(File &indexFile) {
+    for (int levelIndex = 0; levelIndex < (int)g_indexHeader.numLevels; levelIndex++) {
+        if (g_indexLevelBuilders[levelIndex].count > 0) {
+            if (!emitIndexLevelRow(indexFile, levelIndex)) {
+                return false;
+            }
+        }
+    }
+
+    for (int levelIndex = 0; levelIndex < (int)g_indexHeader.numLevels; levelIndex++) {
+        if (!flushIndexLevel(indexFile, levelIndex)) {
+            return false;
+        }
+        if (g_indexLevelBuilders[levelIndex].numWrittenRows != g_indexHeader.levelNumRows[levelIndex]) {
+            return false;
+        }
+    }
+
+    g_indexHeader.magic = INDEX_MAGIC;
+    return indexFile.seek(0) && indexFile.write((const uint8_t *)&g_indexHeader, sizeof(IndexHeader)) == sizeof(IndexHeader);
+}
+
+// this is called from the thread that owns SD card
+void buildIndex() {
+    g_indexBuildPending = false;
+
+    if (g_indexState != INDEX_STATE_BUILDING) {
+        return;
+    }
+
+    char indexFilePath[MAX_PATH_LENGTH + 1];
+    getIndexFilePath(g_filePath, indexFilePath);
+
+    bool result = false;
+
+    PlatformDataFile file;
+    File indexFile;
+    if (
+        file.open(g_filePath) &&
+        indexFile.open(indexFilePath, g_indexBuildSample == 0 ? FILE_CREATE_ALWAYS | FILE_WRITE : FILE_OPEN_ALWAYS | FILE_WRITE)
+    ) {
+        DataReader reader(file, DATA_BLOCK_BUFFER);
+
+        uint32_t numYAxes = g_recording.parameters.numYAxes;
+        uint32_t sampleSize = numYAxes * sizeof(float);
+        uint32_t samplesPerRead = INDEX_READ_BUFFER_SIZE / sampleSize;
+        float *values = (float *)(INDEX_BUFFER + MAX_INDEX_LEVELS * INDEX_LEVEL_BUFFER_SIZE);
+
+        if (g_indexBuildSample == 0) {
+            // invalid header until index is complete
+            result = indexFile.write((const uint8_t *)&g_indexHeader, sizeof(IndexHeader)) == sizeof(IndexHeader);
+        } else {
+            result = true;
+        }
+
+        uint32_t samplesPerSlice = MAX(INDEX_BYTES_PER_SLICE / sampleSize, 1);
+        uint32_t sliceEndSample = MIN(g_indexBuildSample + samplesPerSlice, g_indexHeader.numSamples);
+
+        // this slice is read sequentially and the next one is prefetched while GUI is running
+        adviseSamples(reader, g_indexBuildSample, sliceEndSample, DataFile::ACCESS_SEQUENTIAL);
+        adviseSamples(reader, sliceEndSample, MIN(sliceEndSample + samplesPerSlice, g_indexHeader.numSamples), DataFile::ACCESS_WILL_NEED);
+
+        BlockElement elements[MAX_NUM_OF_Y_VALUES];
+
+        while (result && g_indexBuildSample < sliceEndSample) {
+            uint32_t numSamples = MIN(samplesPerRead, sliceEndSample - g_indexBuildSample);
+            const float *rows = getSamples(reader, g_indexBuildSample, numSamples, values);
+            if (!rows) {
+                result = false;
+                break;
+            }
+
+            for (uint32_t i = 0; i < numSamples && result; i++) {
+                for (unsigned k = 0; k < g_indexHeader.numElementsPerRow; k++) {
+                    elements[k].min = elements[k].max = rows[i * numYAxes + k];
+                }
+                result = addToIndexLevel(indexFile, 0, elements);
+            }
+
+            g_indexBuildSample += numSamples;
+        }
+
+        for (int levelIndex = 0; result && levelIndex < (int)g_indexHeader.numLevels; levelIndex++) {
+            result = flushIndexLevel(indexFile, levelIndex);
+        }
+
+        if (result && g_indexBuildSample == g_indexHeader.numSamples) {
+            result = finishIndex(indexFile);
+            if (result) {
+                g_indexState = INDEX_STATE_READY;
+            }
+        }
+    }
+
+    file.close();
+    indexFile.close();
+
+    if (!result) {
+        g_indexState = INDEX_STATE_NONE;
+    }
+}
+
+static int getIndexLevel(unsigned numSamplesPerValue) {
+    if (g_indexState != INDEX_STATE_READY || numSamplesPerValue < INDEX_BASE_FACTOR) {
+        return -1;
+    }
+
+    int levelIndex = 0;
+    uint32_t factor = INDEX_BASE_FACTOR * INDEX_LEVEL_FACTOR;
+    while (levelIndex + 1 < (int)g_indexHeader.numLevels && factor <= numSamplesPerValue) {
+        levelIndex++;
+        factor *= INDEX_LEVEL_FACTOR;
+    }
+    return levelIndex;
+}
+
+static uint32_t getIndexLevelFactor(int levelIndex) {
+    uint32_t factor = INDEX_BASE_FACTOR;
+    for (int i = 0; i < levelIndex; i++) {
+        factor *= INDEX_LEVEL_FACTOR;
+    }
+    return factor;
+}
 
-                if (totalBytesRead > NUM_ELEMENTS_PER_BLOCKS * sizeof(BlockElement)) {
+////////////////////////////////////////////////////////////////////////////////
+
+static void loadBlockFromIndex(int levelIndex, unsigned numSamplesPerValue) {
+    static const int NUM_INDEX_ROWS = 8;
+    BlockElement levelElements[MAX_NUM_OF_Y_VALUES * NUM_INDEX_ROWS];
+    BlockElement rowElements[MAX_NUM_OF_Y_VALUES];
+
+    char indexFilePath[MAX_PATH_LENGTH + 1];
+    getIndexFilePath(g_filePath, indexFilePath);
+
+    File indexFile;
+    if (indexFile.open(indexFilePath, FILE_OPEN_EXISTING | FILE_READ)) {
+        auto numElementsPerRow = getNumElementsPerRow();
+        uint32_t rowSize = numElementsPerRow * sizeof(BlockElement);
+
+        uint32_t factor = getIndexLevelFactor(levelIndex);
+        uint32_t levelNumRows = g_indexHeader.levelNumRows[levelIndex];
+
+        uint32_t blockStartElement = g_cacheBlocks[g_blockIndexToLoad].startAddress / sizeof(BlockElement);
+
+        uint32_t totalBytesRead = 0;
+
+        uint32_t i = g_cacheBlocks[g_blockIndexToLoad].loadedValues;
+        while (i < NUM_ELEMENTS_PER_BLOCKS) {
+            if (g_interruptLoading) {
+                // block stays in the cache and loading will continue from here
+                break;
+            }
+
+            uint32_t rowIndex = (blockStartElement + i) / numElementsPerRow;
+            uint32_t columnIndex = (blockStartElement + i) % numElementsPerRow;
+
+            uint32_t startSample = getStartSample(rowIndex);
+            uint32_t firstLevelRow = startSample / factor;
+            uint32_t lastLevelRow = MIN((startSample + numSamplesPerValue - 1) / factor, firstLevelRow + NUM_INDEX_ROWS - 1);
+            if (lastLevelRow >= levelNumRows) {
+                if (firstLevelRow >= levelNumRows) {
+                    i = NUM_ELEMENTS_PER_BLOCKS;
                     break;
                 }
+                lastLevelRow = levelNumRows - 1;
+            }
 
-                g_refreshed = true;
+            uint32_t numLevelRows = lastLevelRow - firstLevelRow + 1;
+            uint32_t bytesToRead = numLevelRows * rowSize;
+            if (
+                !indexFile.seek(g_indexHeader.levelOffsets[levelIndex] + firstLevelRow * rowSize) ||
+                (uint32_t)indexFile.read(levelElements, bytesToRead) != bytesToRead
+            ) {
+                i = NUM_ELEMENTS_PER_BLOCKS;
+                break;
             }
 
-        closeFile:
-            g_cacheBlocks[g_blockIndexToLoad].loadedValues = i;
-            file.close();
+            totalBytesRead += bytesToRead;
+
+            memcpy(rowElements, levelElements, rowSize);
+            for (uint32_t j = 1; j < numLevelRows; j++) {
+                for (unsigned k = 0; k < numElementsPerRow; k++) {
+                    mergeBlockElement(rowElements[k], levelElements[j * numElementsPerRow + k]);
+                }
+            }
+
+            for (unsigned k = columnIndex; k < numElementsPerRow && i < NUM_ELEMENTS_PER_BLOCKS; k++) {
+                setCacheBlockElement(i++, k, rowElements[k]);
+            }
+
+            g_refreshed = true;
+
+            if (totalBytesRead > NUM_ELEMENTS_PER_BLOCKS * sizeof(BlockElement)) {
+                break;
+            }
+        }
+
+        g_cacheBlocks[g_blockIndexToLoad].loadedValues = i;
+    } else {
+        g_indexState = INDEX_STATE_NONE;
+    }
+
+    indexFile.close();
+}
+
+// Loads cache block elements from loadedElement up to endElement. Loading stops early if it is
+// interrupted or after maxBytesToRead, and loadedElement is updated as elements are loaded.
+// If loadedValues is set, progress is also published to it, so it is immediately visible.
+static void loadElementsFromFile(DataReader &reader, uint32_t &loadedElement, uint32_t endElement, unsigned numSamplesPerValue, uint32_t maxBytesToRead, std::atomic<uint32_t> *loadedValues) {
+    BlockElement rowElements[MAX_NUM_OF_Y_VALUES];
+
+    auto numElementsPerRow = getNumElementsPerRow();
+    uint32_t sampleSize = g_recording.parameters.numYAxes * sizeof(float);
+
+    uint32_t blockStartElement = g_cacheBlocks[g_blockIndexToLoad].startAddress / sizeof(BlockElement);
+
+    uint32_t totalBytesRead = 0;
+
+    uint32_t i = loadedElement;
+    while (i < endElement) {
+        uint32_t rowIndex = (blockStartElement + i) / numElementsPerRow;
+        uint32_t columnIndex = (blockStartElement + i) % numElementsPerRow;
+
+        uint32_t startSample = getStartSample(rowIndex);
+        if (startSample >= g_recording.numSamples) {
+            i = endElement;
+            break;
+        }
+
+        uint32_t numSamples = MIN(numSamplesPerValue, g_recording.numSamples - startSample);
+        if (!readMinMax(reader, startSample, numSamples, rowElements)) {
+            if (!g_interruptLoading) {
+                i = endElement;
+            }
+            break;
+        }
+
+        for (unsigned k = columnIndex; k < numElementsPerRow && i < endElement; k++) {
+            setCacheBlockElement(i++, k, rowElements[k]);
+        }
+
+        loadedElement = i;
+        if (loadedValues) {
+            loadedValues->store(i, std::memory_order_release);
+        }
+        g_refreshed = true;
+
+        totalBytesRead += numSamples * sampleSize;
+        if (totalBytesRead > maxBytesToRead) {
+            break;
+        }
+    }
+
+    loadedElement = i;
+    if (loadedValues) {
+        loadedValues->store(i, std::memory_order_release);
+    }
+}
+
+static void adviseBlock(DataReader &reader, unsigned numSamplesPerValue) {
+    auto numElementsPerRow = getNumElementsPerRow();
+    uint32_t blockStartElement = g_cacheBlocks[g_blockIndexToLoad].startAddress / sizeof(BlockElement);
+
+    // When zoomed out the whole range is read once, so let the OS read ahead and drop
+    // the pages behind. When zoomed in the range is small and it is prefetched at once.
+    uint32_t startSample = getStartSample(blockStartElement / numElementsPerRow);
+    uint32_t endSample = MIN(getStartSample((blockStartElement + NUM_ELEMENTS_PER_BLOCKS) / numElementsPerRow), g_recording.numSamples);
+    adviseSamples(reader, startSample, endSample, numSamplesPerValue > 1 ? DataFile::ACCESS_SEQUENTIAL : DataFile::ACCESS_WILL_NEED);
+}
+
+#if !defined(DLOG_VIEW_LOAD_WORKERS)
+static void loadBlockFromFile(unsigned numSamplesPerValue) {
+    PlatformDataFile file;
+    if (file.open(g_filePath)) {
+        DataReader reader(file, DATA_BLOCK_BUFFER);
+
+        if (g_cacheBlocks[g_blockIndexToLoad].loadedValues == 0) {
+            adviseBlock(reader, numSamplesPerValue);
         }
+
+        CacheBlock &cacheBlock = g_cacheBlocks[g_blockIndexToLoad];
+        uint32_t loadedElement = cacheBlock.loadedValues;
+        loadElementsFromFile(reader, loadedElement, NUM_ELEMENTS_PER_BLOCKS, numSamplesPerValue, NUM_ELEMENTS_PER_BLOCKS * sizeof(BlockElement), &cacheBlock.loadedValues);
     }
 
+    file.close();
+}
+#endif
+
+static void finishLoading() {
+#ifdef DEBUG
+    debug::g_dlogBlockLoadDuration.finish();
+#endif
+
     g_isLoading = false;
     g_refreshed = true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(DLOG_VIEW_LOAD_WORKERS)
+
+// In the simulator, cache block is loaded from the file by the pool of worker threads. Every worker
+// loads its own range of block elements, so SCPI thread is not blocked while large file is decimated.
+// Ranges are aligned to the segments, so segment ranges of the block are never updated concurrently.
+// When all the jobs are finished, loading is finished by the SCPI thread (see onLoadJobsFinished).
+static const uint32_t NUM_LOAD_WORKERS = 4;
+
+struct LoadJob {
+    uint32_t startElement;
+    uint32_t endElement;
+    uint32_t loadedElement;
+};
+
+static std::mutex g_loadWorkersMutex;
+static std::condition_variable g_loadWorkersCondition;
+static std::thread g_loadWorkers[NUM_LOAD_WORKERS];
+static bool g_loadWorkersStarted;
+static bool g_loadWorkersStop;
+static LoadJob g_loadJobs[NUM_LOAD_WORKERS];
+static uint32_t g_numLoadJobs;
+static uint32_t g_nextLoadJob;
+static uint32_t g_numFinishedLoadJobs;
+static bool g_loadJobsFinishPending;
+static unsigned g_loadJobNumSamplesPerValue;
+static char g_loadJobFilePath[MAX_PATH_LENGTH + 1];
+
+// called, with the mutex locked, when all jobs are finished
+static void finishLoadJobs() {
+    // loaded elements are always at the start of the block, so stop at the first job that is not finished
+    uint32_t loadedValues = g_loadJobs[0].loadedElement;
+    for (uint32_t jobIndex = 1; jobIndex < g_numLoadJobs && loadedValues == g_loadJobs[jobIndex - 1].endElement; jobIndex++) {
+        loadedValues = g_loadJobs[jobIndex].loadedElement;
+    }
+    g_cacheBlocks[g_blockIndexToLoad].loadedValues.store(loadedValues, std::memory_order_release);
+
+    g_numLoadJobs = 0;
+    g_nextLoadJob = 0;
+    g_numFinishedLoadJobs = 0;
+    g_loadJobsFinishPending = true;
+}
+
+// called, with the mutex locked, in the SCPI thread
+static void finishLoadJobsInScpiThread() {
+    if (g_loadJobsFinishPending) {
+        g_loadJobsFinishPending = false;
+        finishLoading();
+    }
+}
+
+static void loadWorkerThread() {
+    // used for the compressed data blocks if file is not mapped
+    static thread_local uint8_t dataBlockBuffer[dlog_codec::BLOCK_SIZE];
+
+    std::unique_lock<std::mutex> lock(g_loadWorkersMutex);
+
+    while (true) {
+        g_loadWorkersCondition.wait(lock, [] { return g_loadWorkersStop || g_nextLoadJob < g_numLoadJobs; });
+        if (g_loadWorkersStop) {
+            break;
+        }
+
+        uint32_t jobIndex = g_nextLoadJob++;
+        LoadJob &job = g_loadJobs[jobIndex];
+
+        lock.unlock();
+
+        PlatformDataFile file;
+        if (file.open(g_loadJobFilePath)) {
+            DataReader reader(file, dataBlockBuffer);
+
+            if (job.startElement == 0) {
+                adviseBlock(reader, g_loadJobNumSamplesPerValue);
+            }
+
+            // progress of the first job is immediately visible
+            std::atomic<uint32_t> *loadedValues = jobIndex == 0 ? &g_cacheBlocks[g_blockIndexToLoad].loadedValues : nullptr;
+            loadElementsFromFile(reader, job.loadedElement, job.endElement, g_loadJobNumSamplesPerValue, UINT32_MAX, loadedValues);
+
+            file.close();
+        }
+
+        lock.lock();
+
+        if (++g_numFinishedLoadJobs == g_numLoadJobs) {
+            finishLoadJobs();
+
+            // wake up stopLoading
+            g_loadWorkersCondition.notify_all();
+
+            lock.unlock();
+            osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_DLOG_LOAD_JOBS_FINISHED, 0), osWaitForever);
+            lock.lock();
+        }
+    }
+}
+
+static void startLoadJobs(unsigned numSamplesPerValue) {
+    std::unique_lock<std::mutex> lock(g_loadWorkersMutex);
+
+    if (!g_loadWorkersStarted) {
+        for (uint32_t i = 0; i < NUM_LOAD_WORKERS; i++) {
+            g_loadWorkers[i] = std::thread(loadWorkerThread);
+        }
+        g_loadWorkersStarted = true;
+    }
+
+    strcpy(g_loadJobFilePath, g_filePath);
+    g_loadJobNumSamplesPerValue = numSamplesPerValue;
+
+    uint32_t startElement = g_cacheBlocks[g_blockIndexToLoad].loadedValues;
+    uint32_t numSegments = (NUM_ELEMENTS_PER_BLOCKS - startElement + NUM_ELEMENTS_PER_SEGMENT - 1) / NUM_ELEMENTS_PER_SEGMENT;
+    uint32_t numSegmentsPerJob = (numSegments + NUM_LOAD_WORKERS - 1) / NUM_LOAD_WORKERS;
+
+    g_numLoadJobs = 0;
+    while (startElement < NUM_ELEMENTS_PER_BLOCKS) {
+        uint32_t endElement = MIN((startElement / NUM_ELEMENTS_PER_SEGMENT + numSegmentsPerJob) * NUM_ELEMENTS_PER_SEGMENT, NUM_ELEMENTS_PER_BLOCKS);
+        LoadJob &job = g_loadJobs[g_numLoadJobs++];
+        job.startElement = startElement;
+        job.endElement = endElement;
+        job.loadedElement = startElement;
+        startElement = endElement;
+    }
+
+    g_nextLoadJob = 0;
+    g_numFinishedLoadJobs = 0;
+
+    g_loadWorkersCondition.notify_all();
+}
+
+#endif
+
+// Interrupts loading of the cache block and waits until g_recording and FILE_VIEW_BUFFER are
+// no longer used by the load workers. Without the workers, block is loaded by the SCPI thread.
+// Called from the SCPI thread.
+static void stopLoading() {
+    g_interruptLoading = true;
+
+#if defined(DLOG_VIEW_LOAD_WORKERS)
+    std::unique_lock<std::mutex> lock(g_loadWorkersMutex);
+    g_loadWorkersCondition.wait(lock, [] { return g_numFinishedLoadJobs == g_numLoadJobs; });
+
+    // don't wait for the message, it is behind the message that is handled now
+    finishLoadJobsInScpiThread();
+#endif
+}
+
+void onLoadJobsFinished() {
+#if defined(DLOG_VIEW_LOAD_WORKERS)
+    std::unique_lock<std::mutex> lock(g_loadWorkersMutex);
+    finishLoadJobsInScpiThread();
+#endif
+}
+
+void shutdown() {
+    stopLoading();
+
+#if defined(DLOG_VIEW_LOAD_WORKERS)
+    {
+        std::unique_lock<std::mutex> lock(g_loadWorkersMutex);
+        if (!g_loadWorkersStarted) {
+            return;
+        }
+        g_loadWorkersStop = true;
+        g_loadWorkersCondition.notify_all();
+    }
+
+    for (uint32_t i = 0; i < NUM_LOAD_WORKERS; i++) {
+        g_loadWorkers[i].join();
+    }
+
+    g_loadWorkersStarted = false;
+    g_loadWorkersStop = false;
+#endif
+}
+
+void loadBlock() {
+    auto numSamplesPerValue = (unsigned)round(g_loadScale);
+    if (numSamplesPerValue > 0) {
+        int indexLevel = getIndexLevel(numSamplesPerValue);
+        if (indexLevel != -1) {
+            loadBlockFromIndex(indexLevel, numSamplesPerValue);
+        } else {
+#if defined(DLOG_VIEW_LOAD_WORKERS)
+            if (g_cacheBlocks[g_blockIndexToLoad].loadedValues < NUM_ELEMENTS_PER_BLOCKS) {
+                // loading is finished by the last worker
+                startLoadJobs(numSamplesPerValue);
+                return;
+            }
+#else
+            loadBlockFromFile(numSamplesPerValue);
+#endif
+        }
+    }
+
+    finishLoading();
+}
+
+static uint32_t getBlockStartAddress(uint32_t rowIndex) {
+    return (rowIndex * getNumElementsPerRow() * sizeof(BlockElement)) / BLOCK_SIZE * BLOCK_SIZE;
+}
+
+static int findCacheBlock(uint32_t blockStartAddress, float loadScale) {
+    CacheBlock *cacheBlock = &g_cacheBlocks[g_cacheBlockIndexHint];
+    if (cacheBlock->valid && cacheBlock->startAddress == blockStartAddress && cacheBlock->loadScale == loadScale) {
+        return g_cacheBlockIndexHint;
+    }
+
+    for (uint32_t blockIndex = 0; blockIndex < NUM_BLOCKS; blockIndex++) {
+        cacheBlock = &g_cacheBlocks[blockIndex];
+        if (cacheBlock->valid && cacheBlock->startAddress == blockStartAddress && cacheBlock->loadScale == loadScale) {
+            g_cacheBlockIndexHint = blockIndex;
+            return blockIndex;
+        }
+    }
+
+    return -1;
+}
+
+// Evicts, in this order: unused block, block from the other zoom that was not used for the longest time,
+// block that is farthest from the viewport. Block that is currently loading is never evicted.
+static uint32_t allocCacheBlock(uint32_t blockStartAddress, float loadScale) {
+    uint32_t viewportAddress = getBlockStartAddress(getPosition(g_recording));
+
+    int selectedBlockIndex = -1;
+    uint32_t selectedScore = 0;
+
+    for (uint32_t blockIndex = 0; blockIndex < NUM_BLOCKS; blockIndex++) {
+        if (g_isLoading && blockIndex == g_blockIndexToLoad) {
+            continue;
+        }
+
+        CacheBlock &cacheBlock = g_cacheBlocks[blockIndex];
+
+        uint32_t score;
+        if (!cacheBlock.valid) {
+            score = 0xFFFFFFFF;
+        } else if (cacheBlock.loadScale != loadScale) {
+            score = 0x80000000 | MIN(g_cacheUseCounter - cacheBlock.lastUsed, 0x7FFFFFFE);
+        } else {
+            uint32_t distance = cacheBlock.startAddress > viewportAddress ? cacheBlock.startAddress - viewportAddress : viewportAddress - cacheBlock.startAddress;
+            score = MIN(distance / BLOCK_SIZE, 0x7FFFFFFF);
+        }
+
+        if (selectedBlockIndex == -1 || score > selectedScore) {
+            selectedBlockIndex = blockIndex;
+            selectedScore = score;
+        }
+    }
+
+    BlockElement *blockElements = getCacheBlock(selectedBlockIndex);
+    for (unsigned i = 0; i < NUM_ELEMENTS_PER_BLOCKS; i++) {
+        blockElements[i].min = NAN;
+        blockElements[i].max = NAN;
+    }
+
+    CacheBlock &cacheBlock = g_cacheBlocks[selectedBlockIndex];
+    for (unsigned i = 0; i < NUM_SEGMENTS_PER_BLOCK; i++) {
+        for (unsigned k = 0; k < MAX_NUM_OF_Y_VALUES; k++) {
+            cacheBlock.segmentRanges[i][k].min = NAN;
+            cacheBlock.segmentRanges[i][k].max = NAN;
+        }
+    }
+    cacheBlock.valid = 1;
+    cacheBlock.loadedValues = 0;
+    cacheBlock.startAddress = blockStartAddress;
+    cacheBlock.loadScale = loadScale;
+    cacheBlock.lastUsed = g_cacheUseCounter;
+
+    g_cacheBlockIndexHint = selectedBlockIndex;
+
+    return selectedBlockIndex;
+}
+
+static void startLoadingCacheBlock(uint32_t blockIndex) {
+    g_isLoading = true;
+    g_interruptLoading = false;
+    g_blockIndexToLoad = blockIndex;
+    g_loadScale = g_cacheBlocks[blockIndex].loadScale;
+
+#ifdef DEBUG
+    debug::g_dlogBlockLoadDuration.start();
+#endif
+
+    osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_DLOG_LOAD_BLOCK, 0), osWaitForever);
+}
+
+static void updateScrollVelocity(uint32_t oldPosition, uint32_t newPosition) {
+    if (newPosition == oldPosition) {
+        return;
+    }
+
+    uint32_t tickCount = millis();
+    uint32_t timeDiff = tickCount - g_lastScrollTickCount;
+    g_lastScrollTickCount = tickCount;
+
+    int32_t positionDiff = (int32_t)(newPosition - oldPosition);
+    g_scrollDirection = positionDiff > 0 ? 1 : -1;
+
+    if (timeDiff >= SCROLL_IDLE_TIME || timeDiff == 0) {
+        // scrolling just started, velocity is not known yet
+        g_scrollVelocity = 0;
+    } else {
+        g_scrollVelocity = (g_scrollVelocity + positionDiff * 1000.0f / timeDiff) / 2;
+    }
+}
+
+// Called from the GUI thread when nothing else is loading: if all the visible blocks are loaded,
+// starts loading of the first missing block in the scroll direction, then the one behind the viewport.
+static void readAhead() {
+    if (g_isLoading || g_state != STATE_READY || &getRecording() != &g_recording || g_recording.size == 0) {
+        return;
+    }
+
+    if (millis() - g_lastScrollTickCount >= SCROLL_IDLE_TIME) {
+        g_scrollVelocity = 0;
+    }
+
+    float loadScale = g_recording.xAxisDiv / g_recording.xAxisDivMin;
+
+    uint32_t position = getPosition(g_recording);
+    uint32_t firstBlock = getBlockStartAddress(position) / BLOCK_SIZE;
+    uint32_t lastBlock = getBlockStartAddress(MIN(position + g_recording.pageSize, g_recording.size) - 1) / BLOCK_SIZE;
+    uint32_t numBlocks = getBlockStartAddress(g_recording.size - 1) / BLOCK_SIZE + 1;
+
+    for (uint32_t block = firstBlock; block <= lastBlock; block++) {
+        int blockIndex = findCacheBlock(block * BLOCK_SIZE, loadScale);
+        if (blockIndex == -1 || g_cacheBlocks[blockIndex].loadedValues < NUM_ELEMENTS_PER_BLOCKS) {
+            // visible blocks are loaded first, on request from getValue
+            return;
+        }
+    }
+
+    uint32_t rowsPerBlock = BLOCK_SIZE / (getNumElementsPerRow() * sizeof(BlockElement));
+    uint32_t numReadAheadBlocks = 1 + MIN((uint32_t)(fabsf(g_scrollVelocity) * READ_AHEAD_TIME / rowsPerBlock), MAX_READ_AHEAD_BLOCKS - 1);
+
+    int32_t candidates[MAX_READ_AHEAD_BLOCKS + 1];
+    uint32_t numCandidates = 0;
+    for (uint32_t i = 1; i <= numReadAheadBlocks; i++) {
+        candidates[numCandidates++] = g_scrollDirection > 0 ? (int32_t)(lastBlock + i) : (int32_t)firstBlock - (int32_t)i;
+    }
+    candidates[numCandidates++] = g_scrollDirection > 0 ? (int32_t)firstBlock - 1 : (int32_t)(lastBlock + 1);
+
+    for (uint32_t i = 0; i < numCandidates; i++) {
+        if (candidates[i] < 0 || (uint32_t)candidates[i] >= numBlocks) {
+            continue;
+        }
+
+        uint32_t blockStartAddress = candidates[i] * BLOCK_SIZE;
+        int blockIndex = findCacheBlock(blockStartAddress, loadScale);
+        if (blockIndex == -1) {
+            blockIndex = allocCacheBlock(blockStartAddress, loadScale);
+        }
+
+        g_cacheBlocks[blockIndex].lastUsed = g_cacheUseCounter;
+
+        if (g_cacheBlocks[blockIndex].loadedValues < NUM_ELEMENTS_PER_BLOCKS) {
+#ifdef DEBUG
+            debug::g_dlogReadAhead.inc();
+#endif
+            startLoadingCacheBlock(blockIndex);
+            return;
+        }
+    }
+}
+
 void stateManagment() {
     auto isExecuting = dlog_record::isExecuting();
     if (!isExecuting && g_wasExecuting && g_showLatest && gui::getActivePageId() == gui::PAGE_ID_DLOG_VIEW) {
@@ -233,44 +1343,49 @@ void stateManagment() {
     }
     g_wasExecuting = isExecuting;
 
-    if (g_refreshed) {
+    if (g_refreshed.exchange(false)) {
         ++g_recording.refreshCounter;
-        g_refreshed = false;
+    }
+
+    ++g_cacheUseCounter;
+
+    readAhead();
+
+    if (g_indexState == INDEX_STATE_BUILDING && !g_indexBuildPending) {
+        g_indexBuildPending = true;
+        osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_DLOG_BUILD_INDEX, 0), osWaitForever);
     }
 }
 
 float getValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
     uint32_t blockElementAddress = (rowIndex * getNumElementsPerRow() + columnIndex) * sizeof(BlockElement);
 
-    uint32_t blockIndex = blockElementAddress / BLOCK_SIZE;
-    uint32_t blockStartAddress = blockIndex * BLOCK_SIZE;
+    uint32_t blockStartAddress = blockElementAddress / BLOCK_SIZE * BLOCK_SIZE;
+    float loadScale = g_recording.xAxisDiv / g_recording.xAxisDivMin;
 
-    blockIndex %= NUM_BLOCKS;
+    int blockIndex = findCacheBlock(blockStartAddress, loadScale);
+    if (blockIndex == -1) {
+        blockIndex = allocCacheBlock(blockStartAddress, loadScale);
+    }
 
     BlockElement *blockElements = getCacheBlock(blockIndex);
 
-    if (!(g_cacheBlocks[blockIndex].valid && g_cacheBlocks[blockIndex].startAddress == blockStartAddress)) {
-        for (unsigned i = 0; i < NUM_ELEMENTS_PER_BLOCKS; i++) {
-            blockElements[i].min = NAN;
-            blockElements[i].max = NAN;
-        }
-
-        g_cacheBlocks[blockIndex].valid = 1;
-        g_cacheBlocks[blockIndex].loadedValues = 0;
-        g_cacheBlocks[blockIndex].startAddress = blockStartAddress;
-    }
+    g_cacheBlocks[blockIndex].lastUsed = g_cacheUseCounter;
 
     if (g_cacheBlocks[blockIndex].loadedValues < NUM_ELEMENTS_PER_BLOCKS && !g_isLoading) {
-        g_isLoading = true;
-        g_interruptLoading = false;
-        g_blockIndexToLoad = blockIndex;
-        g_loadScale = g_recording.xAxisDiv / g_recording.xAxisDivMin;
-
-        osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_DLOG_LOAD_BLOCK, 0), osWaitForever);
+        startLoadingCacheBlock(blockIndex);
     }
 
     uint32_t blockElementIndex = (blockElementAddress % BLOCK_SIZE) / sizeof(BlockElement);
 
+#ifdef DEBUG
+    if (blockElementIndex < g_cacheBlocks[blockIndex].loadedValues) {
+        debug::g_dlogCacheHit.inc();
+    } else {
+        debug::g_dlogCacheMiss.inc();
+    }
+#endif
+
     BlockElement *blockElement = blockElements + blockElementIndex;
 
     if (g_recording.parameters.yAxisScale == SCALE_LOGARITHMIC) {
@@ -283,6 +1398,68 @@ float getValue(uint32_t rowIndex, uint8_t columnIndex, float *max) {
     return blockElement->min;
 }
 
+// Min and max of the already loaded values, it doesn't start loading of the missing blocks.
+// Whole segments are taken from the segment ranges, only partially covered segments are scanned.
+// Returns false if some part of the rows is not loaded yet.
+static bool getRange(uint32_t rowIndex, uint32_t numRows, uint8_t columnIndex, float *min, float *max) {
+    auto numElementsPerRow = getNumElementsPerRow();
+    float loadScale = g_recording.xAxisDiv / g_recording.xAxisDivMin;
+
+    BlockElement range = { NAN, NAN };
+
+    uint32_t startElement = rowIndex * numElementsPerRow;
+    uint32_t endElement = MIN(rowIndex + numRows, g_recording.size) * numElementsPerRow;
+
+    for (uint32_t blockStartElement = startElement / NUM_ELEMENTS_PER_BLOCKS * NUM_ELEMENTS_PER_BLOCKS; blockStartElement < endElement; blockStartElement += NUM_ELEMENTS_PER_BLOCKS) {
+        int blockIndex = findCacheBlock(blockStartElement * sizeof(BlockElement), loadScale);
+        if (blockIndex == -1) {
+            return false;
+        }
+
+        CacheBlock &cacheBlock = g_cacheBlocks[blockIndex];
+        BlockElement *blockElements = getCacheBlock(blockIndex);
+
+        uint32_t i = MAX(startElement, blockStartElement) - blockStartElement;
+        uint32_t end = MIN(endElement - blockStartElement, NUM_ELEMENTS_PER_BLOCKS);
+        if (cacheBlock.loadedValues.load() < end) {
+            return false;
+        }
+
+        while (i < end) {
+            uint32_t segmentIndex = i / NUM_ELEMENTS_PER_SEGMENT;
+            uint32_t segmentStart = segmentIndex * NUM_ELEMENTS_PER_SEGMENT;
+            uint32_t segmentEnd = segmentStart + NUM_ELEMENTS_PER_SEGMENT;
+
+            if (i == segmentStart && segmentEnd <= end) {
+                mergeBlockElement(range, cacheBlock.segmentRanges[segmentIndex][columnIndex]);
+                i = segmentEnd;
+            } else {
+                segmentEnd = MIN(segmentEnd, end);
+                i += (columnIndex + numElementsPerRow - (blockStartElement + i) % numElementsPerRow) % numElementsPerRow;
+                for (; i < segmentEnd; i += numElementsPerRow) {
+                    mergeBlockElement(range, blockElements[i]);
+                }
+                i = segmentEnd;
+            }
+        }
+    }
+
+    if (isnan(range.min)) {
+        return false;
+    }
+
+    if (g_recording.parameters.yAxisScale == SCALE_LOGARITHMIC) {
+        float logOffset = 1 - g_recording.parameters.yAxes[columnIndex].range.min;
+        *min = log10f(logOffset + range.min);
+        *max = log10f(logOffset + range.max);
+    } else {
+        *min = range.min;
+        *max = range.max;
+    }
+
+    return true;
+}
+
 void adjustXAxisOffset(Recording &recording) {
     auto duration = getDuration(recording);
     if (recording.xAxisOffset + recording.pageSize * recording.parameters.period > duration) {
@@ -320,8 +1497,10 @@ void changeXAxisOffset(Recording &recording, float xAxisOffset) {
     if (&dlog_view::g_recording == &recording) {
         float newXAxisOffset = xAxisOffset;
         if (newXAxisOffset != recording.xAxisOffset) {
+            uint32_t oldPosition = getPosition(recording);
             recording.xAxisOffset = newXAxisOffset;
             adjustXAxisOffset(recording);
+            updateScrollVelocity(oldPosition, getPosition(recording));
         }
     } else {
         recording.xAxisOffset = xAxisOffset;
@@ -342,7 +1521,11 @@ void changeXAxisDiv(Recording &recording, float xAxisDiv) {
         
         adjustXAxisOffset(recording);
 
-        invalidateAllBlocks();
+        // blocks are cached per zoom, only stop loading of the block for the previous zoom
+        if (&dlog_view::g_recording == &recording) {
+            g_interruptLoading = true;
+            g_scrollVelocity = 0;
+        }
     }
 }
 
@@ -400,6 +1583,15 @@ void initAxis(Recording &recording) {
         }
     }
 
+    if (recording.parameters.logTimestamp) {
+        recording.parameters.yAxes[yAxisIndex].unit = UNIT_SECOND;
+        recording.parameters.yAxes[yAxisIndex].range.min = 0;
+        recording.parameters.yAxes[yAxisIndex].range.max = recording.parameters.period;
+        recording.parameters.yAxes[yAxisIndex].channelIndex = -1;
+        strcpy(recording.parameters.yAxes[yAxisIndex].label, "Jitter");
+        ++yAxisIndex;
+    }
+
     recording.parameters.numYAxes = yAxisIndex;
 }
 
@@ -411,6 +1603,7 @@ void initDlogValues(Recording &recording) {
     uint8_t yAxisIndex;
     for (yAxisIndex = 0; yAxisIndex < MIN(recording.parameters.numYAxes, MAX_NUM_OF_Y_VALUES); yAxisIndex++) {
         int8_t channelIndex = recording.parameters.yAxes[yAxisIndex].channelIndex;
+        bool isTimestamp = channelIndex == -1 && recording.parameters.yAxes[yAxisIndex].unit == UNIT_SECOND;
 
         // TODO this is not logical
         if (channelIndex == -1) {
@@ -419,7 +1612,9 @@ void initDlogValues(Recording &recording) {
 
         recording.dlogValues[yAxisIndex].isVisible = true;
 
-        if (recording.parameters.yAxes[yAxisIndex].unit == UNIT_VOLT) {
+        if (isTimestamp) {
+            recording.dlogValues[yAxisIndex].dlogValueType = dlog_view::DLOG_VALUE_TIMESTAMP;
+        } else if (recording.parameters.yAxes[yAxisIndex].unit == UNIT_VOLT) {
             recording.dlogValues[yAxisIndex].dlogValueType = (dlog_view::DlogValueType)(3 * channelIndex + dlog_view::DLOG_VALUE_CH1_U);
         } else if (recording.parameters.yAxes[yAxisIndex].unit == UNIT_AMPER) {
             recording.dlogValues[yAxisIndex].dlogValueType = (dlog_view::DlogValueType)(3 * channelIndex + dlog_view::DLOG_VALUE_CH1_I);
@@ -538,7 +1733,31 @@ void scaleToFit(Recording &recording) {
     float totalMin = FLT_MAX;
     float totalMax = -FLT_MAX;
 
-    for (auto position = startPosition; position < startPosition + recording.pageSize; position++) {
+    bool rangeFound = false;
+    if (recording.getRange) {
+        // ranges are maintained while values are loaded/recorded, so there is no need to scan the whole page
+        rangeFound = true;
+        for (auto visibleDlogValueIndex = 0; visibleDlogValueIndex < numVisibleDlogValues && rangeFound; visibleDlogValueIndex++) {
+            int dlogValueIndex = getDlogValueIndex(recording, visibleDlogValueIndex);
+
+            float min;
+            float max;
+            rangeFound = recording.getRange(startPosition, recording.pageSize, dlogValueIndex, &min, &max);
+            if (min < totalMin) {
+                totalMin = min;
+            }
+            if (max > totalMax) {
+                totalMax = max;
+            }
+        }
+
+        if (!rangeFound) {
+            totalMin = FLT_MAX;
+            totalMax = -FLT_MAX;
+        }
+    }
+
+    for (auto position = startPosition; position < startPosition + recording.pageSize && !rangeFound; position++) {
         for (auto visibleDlogValueIndex = 0; visibleDlogValueIndex < numVisibleDlogValues; visibleDlogValueIndex++) {
             int dlogValueIndex = getDlogValueIndex(recording, visibleDlogValueIndex);
 
@@ -553,6 +1772,11 @@ void scaleToFit(Recording &recording) {
         }
     }
 
+    if (totalMin > totalMax) {
+        // no values on the page
+        return;
+    }
+
     for (auto visibleDlogValueIndex = 0; visibleDlogValueIndex < numVisibleDlogValues; visibleDlogValueIndex++) {
         int dlogValueIndex = getDlogValueIndex(recording, visibleDlogValueIndex);
         DlogValueParams &dlogValueParams = recording.dlogValues[dlogValueIndex];
@@ -566,18 +1790,25 @@ void openFile(const char *filePath) {
     if (osThreadGetId() != g_scpiTaskHandle) {
         g_state = STATE_LOADING;
         g_loadingStartTickCount = millis();
+        g_indexState = INDEX_STATE_NONE;
 
         strcpy(g_filePath, filePath);
-        memset(&g_recording, 0, sizeof(Recording));
+
+        // g_recording is cleared by the SCPI thread, after the block that is loading is stopped
+        g_interruptLoading = true;
 
         osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_DLOG_SHOW_FILE, 0), osWaitForever);
         return;
     }
 
-    File file;
-    if (file.open(g_filePath, FILE_OPEN_EXISTING | FILE_READ)) {
+    stopLoading();
+
+    memset(&g_recording, 0, sizeof(Recording));
+
+    PlatformDataFile file;
+    if (file.open(g_filePath)) {
         uint8_t * buffer = FILE_VIEW_BUFFER;
-        uint32_t read = file.read(buffer, DLOG_VERSION1_HEADER_SIZE);
+        uint32_t read = file.read(0, buffer, DLOG_VERSION1_HEADER_SIZE);
         if (read == DLOG_VERSION1_HEADER_SIZE) {
             uint32_t offset = 0;
 
@@ -585,7 +1816,7 @@ void openFile(const char *filePath) {
             uint32_t magic2 = readUint32(buffer, offset);
             uint16_t version = readUint16(buffer, offset);
 
-            if (magic1 == MAGIC1 && magic2 == MAGIC2 && (version == VERSION1 || version == VERSION2)) {
+            if (magic1 == MAGIC1 && magic2 == MAGIC2 && (version == VERSION1 || version == VERSION2 || version == VERSION3)) {
                 bool invalidHeader = false;
 
                 if (version == VERSION1) {
@@ -614,7 +1845,7 @@ void openFile(const char *filePath) {
                     // read the rest of the header
                     if (DLOG_VERSION1_HEADER_SIZE < g_recording.dataOffset) {
                         uint32_t headerRemaining = g_recording.dataOffset - DLOG_VERSION1_HEADER_SIZE;
-                        uint32_t read = file.read(buffer + DLOG_VERSION1_HEADER_SIZE, headerRemaining);
+                        uint32_t read = file.read(DLOG_VERSION1_HEADER_SIZE, buffer + DLOG_VERSION1_HEADER_SIZE, headerRemaining);
                         if (read != headerRemaining) {
                             invalidHeader = true;
                         }
@@ -719,12 +1950,32 @@ void openFile(const char *filePath) {
 					g_recording.parameters.time = g_recording.parameters.xAxis.range.max - g_recording.parameters.xAxis.range.min;
                 }
 
+                g_recording.parameters.compression = version == VERSION3;
+
+                if (!invalidHeader && g_recording.parameters.compression) {
+                    // number of samples is known from the header of the last block
+                    g_numDataBlocks = (file.size() - g_recording.dataOffset + dlog_codec::BLOCK_SIZE - 1) / dlog_codec::BLOCK_SIZE;
+                    if (g_recording.parameters.numYAxes > MAX_NUM_OF_Y_AXES || g_recording.dataOffset > file.size()) {
+                        invalidHeader = true;
+                    } else if (g_numDataBlocks > 0) {
+                        dlog_codec::BlockHeader header;
+                        Range ranges[MAX_NUM_OF_Y_AXES];
+                        if (readDataBlockHeader(file, g_numDataBlocks - 1, header, ranges)) {
+                            g_recording.numSamples = header.firstRow + header.numRows;
+                        } else {
+                            invalidHeader = true;
+                        }
+                    }
+                }
+
                 if (!invalidHeader) {
                     initDlogValues(g_recording);
 
                     g_recording.pageSize = VIEW_WIDTH;
 
-                    g_recording.numSamples = (file.size() - g_recording.dataOffset) / (g_recording.parameters.numYAxes * sizeof(float));
+                    if (!g_recording.parameters.compression) {
+                        g_recording.numSamples = (file.size() - g_recording.dataOffset) / (g_recording.parameters.numYAxes * sizeof(float));
+                    }
                     g_recording.xAxisDivMin = g_recording.pageSize * g_recording.parameters.period / dlog_view::NUM_HORZ_DIVISIONS;
                     g_recording.xAxisDivMax = MAX(g_recording.numSamples, g_recording.pageSize) * g_recording.parameters.period / dlog_view::NUM_HORZ_DIVISIONS;
 
@@ -736,7 +1987,7 @@ void openFile(const char *filePath) {
                     g_recording.cursorOffset = VIEW_WIDTH / 2;
 
                     g_recording.getValue = getValue;
-                    g_isLoading = false;
+                    g_recording.getRange = getRange;
 
                     if (isMulipleValuesOverlayHeuristic(g_recording)) {
                         autoScale(g_recording);
@@ -745,6 +1996,8 @@ void openFile(const char *filePath) {
                     g_state = STATE_READY;
 
                     invalidateAllBlocks();
+
+                    openIndex(file.size());
                 }
             }
         }
@@ -51,6 +51,9 @@ OFFSET    TYPE    WIDTH    DESCRIPTION
 24              U32     4        Start time, timestamp
 
 28+(n*N+m)*4    Float   4        n-th row and m-th column value, N - number of columns
+
+VERSION2 and VERSION3 header is followed by the meta fields and data starts at the offset stored
+in the header. In VERSION3 file data section is a sequence of compressed blocks (see dlog_codec.h).
 */
 
 namespace eez {
@@ -61,6 +64,7 @@ static const uint32_t MAGIC1 = 0x2D5A4545;
 static const uint32_t MAGIC2 = 0x474F4C44;
 static const uint16_t VERSION1 = 1;
 static const uint16_t VERSION2 = 2;
+static const uint16_t VERSION3 = 3; // compressed data blocks
 static const uint32_t DLOG_VERSION1_HEADER_SIZE = 28;
 
 static const int VIEW_WIDTH = 480;
@@ -69,7 +73,7 @@ static const int VIEW_HEIGHT = 240;
 static const int NUM_HORZ_DIVISIONS = 12;
 static const int NUM_VERT_DIVISIONS = 6;
 
-static const int MAX_NUM_OF_Y_AXES = CH_MAX * 3;
+static const int MAX_NUM_OF_Y_AXES = CH_MAX * 3 + 1; // +1 for the timestamp column
 
 static const int MAX_COMMENT_LENGTH = 128;
 
@@ -120,6 +124,7 @@ enum DlogValueType {
     DLOG_VALUE_CH6_U,
     DLOG_VALUE_CH6_I,
     DLOG_VALUE_CH6_P,
+    DLOG_VALUE_TIMESTAMP,
 };
 
 struct Range {
@@ -149,6 +154,15 @@ struct YAxis {
     int8_t channelIndex;
 };
 
+// Row is written only if some value changed more than the threshold since the last written row,
+// otherwise the last written row is repeated. Zero threshold is not used.
+struct Deadband {
+    bool enabled;
+    float absolute;
+    float relative; // in percents of the last written value
+    float maxInterval; // row is written at least this often (in seconds)
+};
+
 struct Parameters {
     char filePath[MAX_PATH_LENGTH + 1];
     char comment[MAX_COMMENT_LENGTH + 1];
@@ -164,9 +178,12 @@ struct Parameters {
     bool logVoltage[CH_MAX];
     bool logCurrent[CH_MAX];
     bool logPower[CH_MAX];
+    bool logTimestamp; // sample time relative to the nominal time (period * sample index)
     float period;
     float time;
     trigger::Source triggerSource;
+    bool compression;
+    Deadband deadband;
 };
 
 struct DlogValueParams {
@@ -192,6 +209,10 @@ struct Recording {
 
     float (*getValue)(uint32_t rowIndex, uint8_t columnIndex, float *max);
 
+    // min and max of the columnIndex values in numRows rows starting from rowIndex,
+    // returns false if it is not known (and then getValue is used for every row)
+    bool (*getRange)(uint32_t rowIndex, uint32_t numRows, uint8_t columnIndex, float *min, float *max);
+
     uint32_t refreshCounter;
 
     uint32_t numSamples;
@@ -215,6 +236,18 @@ extern State getState();
 // this is called from the thread that owns SD card
 void loadBlock();
 
+// this is called from the thread that owns SD card, after the load workers finished loading the block
+void onLoadJobsFinished();
+
+// stops loading and the load workers, this is called from the thread that owns SD card when it is shutting down
+void shutdown();
+
+// this is called from the thread that owns SD card
+void buildIndex();
+
+// min/max index is stored in a separate file next to the dlog file
+void deleteIndexFile(const char *filePath);
+
 // this should be called during GUI state managment phase
 void stateManagment();
 
@@ -0,0 +1,103 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DLOG_VIEW_MIN_MAX_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DLOG_VIEW_MIN_MAX_NEON
+#endif
+
+namespace eez {
+namespace psu {
+namespace dlog_view {
+
+// Reduces column of n values into min and max. Comparisons with NaN are always false,
+// so NaN values (gaps in the recording) are skipped without any extra check.
+inline void reduceMinMax(const float *column, uint32_t n, float &min, float &max) {
+    uint32_t i = 0;
+
+#if defined(DLOG_VIEW_MIN_MAX_SSE2)
+    if (n >= 8) {
+        __m128 vmin = _mm_set1_ps(min);
+        __m128 vmax = _mm_set1_ps(max);
+        for (; i + 4 <= n; i += 4) {
+            // if value is NaN, the second operand is returned
+            __m128 v = _mm_loadu_ps(column + i);
+            vmin = _mm_min_ps(v, vmin);
+            vmax = _mm_max_ps(v, vmax);
+        }
+
+        float mins[4];
+        float maxs[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        for (int j = 0; j < 4; j++) {
+            if (mins[j] < min) {
+                min = mins[j];
+            }
+            if (maxs[j] > max) {
+                max = maxs[j];
+            }
+        }
+    }
+#elif defined(DLOG_VIEW_MIN_MAX_NEON)
+    if (n >= 8) {
+        float32x4_t vmin = vdupq_n_f32(min);
+        float32x4_t vmax = vdupq_n_f32(max);
+        for (; i + 4 <= n; i += 4) {
+            // compare is false for NaN, so the previous min/max is selected
+            float32x4_t v = vld1q_f32(column + i);
+            vmin = vbslq_f32(vcltq_f32(v, vmin), v, vmin);
+            vmax = vbslq_f32(vcgtq_f32(v, vmax), v, vmax);
+        }
+
+        float mins[4];
+        float maxs[4];
+        vst1q_f32(mins, vmin);
+        vst1q_f32(maxs, vmax);
+        for (int j = 0; j < 4; j++) {
+            if (mins[j] < min) {
+                min = mins[j];
+            }
+            if (maxs[j] > max) {
+                max = maxs[j];
+            }
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        float value = column[i];
+        if (value < min) {
+            min = value;
+        }
+        if (value > max) {
+            max = value;
+        }
+    }
+}
+
+} // namespace dlog_view
+} // namespace psu
+} // namespace eez
@@ -0,0 +1,147 @@
+/*
+* EEZ PSU Firmware
+* Copyright (C) 2020-present, Envox d.o.o.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+
+#include <eez/modules/psu/dlog_view_storage.h>
+
+#if defined(DLOG_VIEW_MAPPED_DATA_FILE)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace eez {
+namespace psu {
+namespace dlog_view {
+
+bool BufferedDataFile::open(const char *filePath) {
+    return m_file.open(filePath, FILE_OPEN_EXISTING | FILE_READ);
+}
+
+void BufferedDataFile::close() {
+    m_file.close();
+}
+
+uint32_t BufferedDataFile::size() {
+    return m_file.size();
+}
+
+uint32_t BufferedDataFile::read(uint32_t offset, void *buffer, uint32_t length) {
+    if (!m_file.seek(offset)) {
+        return 0;
+    }
+    int read = m_file.read(buffer, length);
+    return read > 0 ? (uint32_t)read : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(DLOG_VIEW_MAPPED_DATA_FILE)
+
+MappedDataFile::MappedDataFile()
+    : m_isOpen(false), m_data(nullptr), m_size(0)
+{
+}
+
+MappedDataFile::~MappedDataFile() {
+    close();
+}
+
+bool MappedDataFile::open(const char *filePath) {
+    close();
+
+    int fd = ::open(getRealPath(filePath).c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && (uint64_t)fileStat.st_size <= UINT32_MAX) {
+        if (fileStat.st_size == 0) {
+            // empty file can't be mapped
+            m_isOpen = true;
+        } else {
+            void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                m_data = (uint8_t *)data;
+                m_size = (uint32_t)fileStat.st_size;
+                m_isOpen = true;
+            }
+        }
+    }
+
+    // mapping stays valid after the file descriptor is closed
+    ::close(fd);
+
+    return m_isOpen;
+}
+
+void MappedDataFile::close() {
+    if (m_data) {
+        munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+    m_size = 0;
+    m_isOpen = false;
+}
+
+uint32_t MappedDataFile::size() {
+    return m_size;
+}
+
+uint32_t MappedDataFile::read(uint32_t offset, void *buffer, uint32_t length) {
+    if (offset >= m_size) {
+        return 0;
+    }
+    if (length > m_size - offset) {
+        length = m_size - offset;
+    }
+    memcpy(buffer, m_data + offset, length);
+    return length;
+}
+
+const uint8_t *MappedDataFile::map(uint32_t offset, uint32_t length) {
+    if (offset > m_size || length > m_size - offset) {
+        return nullptr;
+    }
+    return m_data + offset;
+}
+
+void MappedDataFile::advise(uint32_t offset, uint32_t length, AccessPattern pattern) {
+    if (offset >= m_size) {
+        return;
+    }
+    if (length > m_size - offset) {
+        length = m_size - offset;
+    }
+
+    // madvise requires page aligned address
+    uint32_t pageSize = (uint32_t)sysconf(_SC_PAGESIZE);
+    uint32_t alignedOffset = offset - offset % pageSize;
+    length += offset - alignedOffset;
+
+    madvise(m_data + alignedOffset, length, pattern == ACCESS_SEQUENTIAL ? MADV_SEQUENTIAL : MADV_WILLNEED);
+}
+
+#endif
+
+} // namespace dlog_view
+} // namespace psu
+} // namespace eez
@@ -0,0 +1,109 @@
+/*
+* EEZ PSU Firmware
+* Copyright (C) 2020-present, Envox d.o.o.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <eez/libs/sd_fat/sd_fat.h>
+
+#if defined(EEZ_PLATFORM_SIMULATOR_UNIX) && !defined(EEZ_PLATFORM_SIMULATOR_EMSCRIPTEN)
+#define DLOG_VIEW_MAPPED_DATA_FILE
+#endif
+
+namespace eez {
+namespace psu {
+namespace dlog_view {
+
+// Read only access to the dlog file used by the viewer.
+class DataFile {
+public:
+    enum AccessPattern {
+        ACCESS_SEQUENTIAL, // range will be read once from the start to the end
+        ACCESS_WILL_NEED   // range will be read soon
+    };
+
+    virtual ~DataFile() {}
+
+    virtual bool open(const char *filePath) = 0;
+    virtual void close() = 0;
+
+    virtual uint32_t size() = 0;
+
+    // returns the number of bytes read
+    virtual uint32_t read(uint32_t offset, void *buffer, uint32_t length) = 0;
+
+    // true if map is supported
+    virtual bool isMapped() { return false; }
+
+    // Returns pointer to the file content without copying it, or nullptr if it is not supported
+    // or range is outside of the file. Pointer is valid until close.
+    virtual const uint8_t *map(uint32_t offset, uint32_t length) { return nullptr; }
+
+    virtual void advise(uint32_t offset, uint32_t length, AccessPattern pattern) {}
+};
+
+// DataFile on top of the SD card File
+class BufferedDataFile : public DataFile {
+public:
+    bool open(const char *filePath) override;
+    void close() override;
+
+    uint32_t size() override;
+
+    uint32_t read(uint32_t offset, void *buffer, uint32_t length) override;
+
+private:
+    File m_file;
+};
+
+#if defined(DLOG_VIEW_MAPPED_DATA_FILE)
+
+// DataFile mapped into the memory of the simulator process
+class MappedDataFile : public DataFile {
+public:
+    MappedDataFile();
+    ~MappedDataFile();
+
+    bool open(const char *filePath) override;
+    void close() override;
+
+    uint32_t size() override;
+
+    uint32_t read(uint32_t offset, void *buffer, uint32_t length) override;
+    bool isMapped() override { return true; }
+    const uint8_t *map(uint32_t offset, uint32_t length) override;
+    void advise(uint32_t offset, uint32_t length, AccessPattern pattern) override;
+
+private:
+    bool m_isOpen;
+    uint8_t *m_data;
+    uint32_t m_size;
+};
+
+typedef MappedDataFile PlatformDataFile;
+
+#else
+
+typedef BufferedDataFile PlatformDataFile;
+
+#endif
+
+} // namespace dlog_view
+} // namespace psu
+} // namespace eez
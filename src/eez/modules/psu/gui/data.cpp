@@ -4689,7 +4689,8 @@ void data_channel_history_values(data::DataOperationEnum operation, data::Cursor
     if (operation == DATA_OPERATION_YT_DATA_GET_GET_VALUE_FUNC) {
         value = Channel::getChannelHistoryValueFuncs(cursor.i);
     } else if (operation == DATA_OPERATION_YT_DATA_GET_REFRESH_COUNTER) {
-        value = Value(0, VALUE_TYPE_UINT32);
+        int iChannel = cursor.i >= 0 ? cursor.i : (g_channel ? g_channel->channelIndex : 0);
+        value = Value(Channel::get(iChannel).getHistoryRefreshCounter(), VALUE_TYPE_UINT32);
     } else if (operation == DATA_OPERATION_YT_DATA_GET_SIZE) {
         value = Value(CHANNEL_HISTORY_SIZE, VALUE_TYPE_UINT32);
     } else if (operation == DATA_OPERATION_YT_DATA_GET_POSITION) {
@@ -611,9 +611,16 @@ void deleteFile() {
     strcat(filePath, "/");
     strcat(filePath, fileItem->name);
 
+    auto fileType = fileItem->type;
+
     int err;
     if (!psu::sd_card::deleteFile(filePath, &err)) {
         errorMessage(Value(err, VALUE_TYPE_SCPI_ERROR));
+        return;
+    }
+
+    if (fileType == FILE_TYPE_DLOG) {
+        psu::dlog_view::deleteIndexFile(filePath);
     }
 }
 
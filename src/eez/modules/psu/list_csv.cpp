@@ -0,0 +1,72 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <eez/util.h>
+
+#include <eez/modules/psu/conf_advanced.h>
+#include <eez/modules/psu/list_csv.h>
+
+namespace eez {
+namespace psu {
+namespace list {
+
+static bool isRowSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool parseListRow(const char *row, size_t rowLength, float *values) {
+    const char *p = row;
+    const char *end = row + rowLength;
+
+    for (int column = 0; column < 3; column++) {
+        const char *columnEnd = column < 2 ? (const char *)memchr(p, CSV_SEPARATOR, end - p) : end;
+        if (!columnEnd) {
+            return false;
+        }
+
+        while (p < columnEnd && isRowSpace(*p)) {
+            p++;
+        }
+
+        if (p < columnEnd && *p == LIST_CSV_FILE_NO_VALUE_CHAR) {
+            values[column] = NAN;
+            p++;
+        } else if (!parseFloat(p, columnEnd, values[column])) {
+            return false;
+        }
+
+        while (p < columnEnd && isRowSpace(*p)) {
+            p++;
+        }
+
+        if (p != columnEnd) {
+            return false;
+        }
+
+        p = columnEnd + 1;
+    }
+
+    return true;
+}
+
+} // namespace list
+} // namespace psu
+} // namespace eez
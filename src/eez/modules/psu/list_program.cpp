@@ -24,11 +24,13 @@
 
 #include <eez/system.h>
 #include <eez/firmware.h>
+#include <eez/memory.h>
 #include <eez/scpi/scpi.h>
 
 #include <eez/modules/psu/psu.h>
 #include <eez/modules/psu/channel_dispatcher.h>
 #include <eez/modules/psu/list_program.h>
+#include <eez/modules/psu/list_stream.h>
 #include <eez/modules/psu/trigger.h>
 #include <eez/modules/psu/sd_card.h>
 #include <eez/modules/psu/io_pins.h>
@@ -37,8 +39,6 @@
 
 #include <eez/libs/sd_fat/sd_fat.h>
 
-#define CONF_COUNTER_THRESHOLD_IN_SECONDS 5
-
 namespace eez {
 
 using namespace scpi;
@@ -59,15 +59,32 @@ static struct {
     uint16_t count;
 } g_channelsLists[CH_MAX];
 
+static_assert(CH_MAX * MAX_LIST_LENGTH * sizeof(ListStep) <= LIST_STEPS_BUFFER_SIZE, "LIST_STEPS_BUFFER is too small");
+
 static struct {
     int32_t counter;
     int16_t it;
-    uint32_t nextPointTime;
-    int32_t currentRemainingDwellTime;
+    uint16_t numSteps;
+    // absolute deadline of the next step (see getTime), it is advanced by the step dwell time
+    // and not set relative to the time when the step was applied, so tick latency doesn't accumulate
+    uint64_t nextPointTime;
+    int32_t currentRemainingDwellTime; // in milliseconds
     float currentTotalDwellTime;
-    uint32_t lastTickCount;
+    uint64_t lastTime;
+
+    // streamed list: last taken step was the last row in the file
+    bool lastInFile;
+
+    // lateness of the applied steps, in microseconds
+    uint32_t numAppliedSteps;
+    uint32_t maxLateness;
+    uint64_t totalLateness;
 } g_execution[CH_MAX];
 
+// 64-bit microseconds counter, so dwell time up to LIST_DWELL_MAX can be measured in microseconds
+static uint64_t g_time;
+static uint32_t g_lastTickUsec;
+
 static bool g_active;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -86,6 +103,8 @@ void resetChannelList(Channel &channel) {
     g_channelsLists[i].count = 1;
 
     g_execution[i].counter = -1;
+
+    streamReset(channel);
 }
 
 void reset() {
@@ -212,6 +231,22 @@ int checkLimits(int iChannel) {
     return 0;
 }
 
+static bool addListValue(float value, int i, float *list, uint16_t &listLength) {
+    if (isNaN(value)) {
+        return true;
+    }
+
+    // list can't continue after the value was skipped
+    if (i != listLength) {
+        return false;
+    }
+
+    list[i] = value;
+    listLength = i + 1;
+
+    return true;
+}
+
 bool loadList(
     sd_card::BufferedFileRead &file,
     float *dwellList, uint16_t &dwellListLength,
@@ -224,6 +259,10 @@ bool loadList(
     voltageListLength = 0;
     currentListLength = 0;
 
+    if (err) {
+        *err = SCPI_RES_OK;
+    }
+
     bool success = true;
 
 #if OPTION_DISPLAY
@@ -236,62 +275,25 @@ bool loadList(
             break;
         }
 
-        float value;
-
-        if (sd_card::match(file, LIST_CSV_FILE_NO_VALUE_CHAR)) {
-            if (i < dwellListLength) {
-                success = false;
-                break;
+        const char *row;
+        size_t rowLength;
+        if (!file.readLine(row, rowLength) || file.isReadError()) {
+            // row could be cut short by the read error
+            if (err) {
+                *err = SCPI_ERROR_MASS_STORAGE_ERROR;
             }
-        } else if (sd_card::match(file, value)) {
-            if (i == dwellListLength) {
-                dwellList[i] = value;
-                dwellListLength = i + 1;
-            } else {
-                success = false;
-                break;
-            }
-        } else {
             success = false;
             break;
         }
 
-        sd_card::match(file, CSV_SEPARATOR);
-
-        if (sd_card::match(file, LIST_CSV_FILE_NO_VALUE_CHAR)) {
-            if (i < voltageListLength) {
-                success = false;
-                break;
-            }
-        } else if (sd_card::match(file, value)) {
-            if (i == voltageListLength) {
-                voltageList[i] = value;
-                ++voltageListLength;
-            } else {
-                success = false;
-                break;
-            }
-        } else {
-            success = false;
-            break;
-        }
-
-        sd_card::match(file, CSV_SEPARATOR);
-
-        if (sd_card::match(file, LIST_CSV_FILE_NO_VALUE_CHAR)) {
-            if (i < currentListLength) {
-                success = false;
-                break;
-            }
-        } else if (sd_card::match(file, value)) {
-            if (i == currentListLength) {
-                currentList[i] = value;
-                ++currentListLength;
-            } else {
-                success = false;
-                break;
-            }
-        } else {
+        float values[3];
+        if (
+            file.isLineTooLong() ||
+            !parseListRow(row, rowLength, values) ||
+            !addListValue(values[0], i, dwellList, dwellListLength) ||
+            !addListValue(values[1], i, voltageList, voltageListLength) ||
+            !addListValue(values[2], i, currentList, currentListLength)
+        ) {
             success = false;
             break;
         }
@@ -306,7 +308,6 @@ bool loadList(
     return success;
 }
 
-
 bool loadList(
     const char *filePath,
     float *dwellList, uint16_t &dwellListLength,
@@ -343,7 +344,7 @@ bool loadList(
     if (err) {
         if (success) {
             *err = SCPI_RES_OK;
-        } else {
+        } else if (*err == SCPI_RES_OK) {
             // TODO replace with more specific error
             *err = SCPI_ERROR_EXECUTION_ERROR;
         }
@@ -373,6 +374,58 @@ bool loadList(int iChannel, const char *filePath, int *err) {
     return false;
 }
 
+// enough for "%.4f" of any float
+static const int MAX_LIST_VALUE_TEXT_LENGTH = 48;
+
+// Same as "%.4f", but without sprintf for the usual list values.
+static char *formatListValue(char *p, const float *list, uint16_t listLength, int i) {
+    if (i >= listLength) {
+        *p++ = LIST_CSV_FILE_NO_VALUE_CHAR;
+        return p;
+    }
+
+    float value = list[i];
+
+    if (isNaN(value) || fabsf(value) >= 1E9f) {
+        return p + sprintf(p, "%.4f", value);
+    }
+
+    if (value < 0) {
+        *p++ = '-';
+    }
+
+    // float is exactly representable in double, also when multiplied by 10000,
+    // so ties can be rounded to even as printf does
+    double scaled = fabs((double)value) * 10000.0;
+    uint64_t n = (uint64_t)scaled;
+    double remainder = scaled - n;
+    if (remainder > 0.5 || (remainder == 0.5 && (n & 1))) {
+        n++;
+    }
+    uint32_t integerPart = (uint32_t)(n / 10000);
+    uint32_t fractionPart = (uint32_t)(n % 10000);
+
+    char digits[10];
+    int numDigits = 0;
+    do {
+        digits[numDigits++] = '0' + integerPart % 10;
+        integerPart /= 10;
+    } while (integerPart > 0);
+
+    while (numDigits > 0) {
+        *p++ = digits[--numDigits];
+    }
+
+    *p++ = '.';
+
+    for (int j = 3; j >= 0; j--) {
+        p[j] = '0' + fractionPart % 10;
+        fractionPart /= 10;
+    }
+
+    return p + 4;
+}
+
 bool saveList(
     sd_card::BufferedFileWrite &file,
     float *dwellList, uint16_t &dwellListLength,
@@ -386,29 +439,18 @@ bool saveList(
 #endif
 
     for (int i = 0; i < dwellListLength || i < voltageListLength || i < currentListLength; i++) {
-        if (i < dwellListLength) {
-            file.print(dwellList[i], 4);
-        } else {
-            file.print(LIST_CSV_FILE_NO_VALUE_CHAR);
-        }
+        // whole row is formatted first and then written at once
+        char row[3 * MAX_LIST_VALUE_TEXT_LENGTH + 3];
+        char *p = row;
 
-        file.print(CSV_SEPARATOR);
+        p = formatListValue(p, dwellList, dwellListLength, i);
+        *p++ = CSV_SEPARATOR;
+        p = formatListValue(p, voltageList, voltageListLength, i);
+        *p++ = CSV_SEPARATOR;
+        p = formatListValue(p, currentList, currentListLength, i);
+        *p++ = '\n';
 
-        if (i < voltageListLength) {
-            file.print(voltageList[i], 4);
-        } else {
-            file.print(LIST_CSV_FILE_NO_VALUE_CHAR);
-        }
-
-        file.print(CSV_SEPARATOR);
-
-        if (i < currentListLength) {
-            file.print(currentList[i], 4);
-        } else {
-            file.print(LIST_CSV_FILE_NO_VALUE_CHAR);
-        }
-
-        file.print('\n');
+        file.write((const uint8_t *)row, p - row);
 
 #if OPTION_DISPLAY
         if (showProgress) {
@@ -493,12 +535,110 @@ void setActive(bool active, bool forceUpdate = false) {
 
 }
 
+static ListStep *getSteps(int channelIndex) {
+    return (ListStep *)LIST_STEPS_BUFFER + channelIndex * MAX_LIST_LENGTH;
+}
+
+static bool checkStepLimits(Channel &channel, const ListStep &step, int *err) {
+    if (step.voltage > channel_dispatcher::getULimit(channel)) {
+        *err = SCPI_ERROR_VOLTAGE_LIMIT_EXCEEDED;
+        return false;
+    }
+
+    if (step.current > channel_dispatcher::getILimit(channel)) {
+        *err = SCPI_ERROR_CURRENT_LIMIT_EXCEEDED;
+        return false;
+    }
+
+    if (step.voltage * step.current > channel_dispatcher::getPowerLimit(channel)) {
+        *err = SCPI_ERROR_POWER_LIMIT_EXCEEDED;
+        return false;
+    }
+
+    return true;
+}
+
+static bool compile(Channel &channel, int *err) {
+    auto &channelLists = g_channelsLists[channel.channelIndex];
+    ListStep *steps = getSteps(channel.channelIndex);
+    uint16_t numSteps = (uint16_t)maxListsSize(channel);
+
+    for (int it = 0; it < numSteps; it++) {
+        ListStep &step = steps[it];
+        step.voltage = channelLists.voltageList[it % channelLists.voltageListLength];
+        step.current = channelLists.currentList[it % channelLists.currentListLength];
+        step.dwell = (uint64_t)round(channelLists.dwellList[it % channelLists.dwellListLength] * 1000000.0);
+
+        if (!checkStepLimits(channel, step, err)) {
+            return false;
+        }
+    }
+
+    g_execution[channel.channelIndex].numSteps = numSteps;
+
+    return true;
+}
+
+static bool setStep(Channel &channel, const ListStep &step, int *err) {
+    // limits can be changed while list is executing
+    if (!checkStepLimits(channel, step, err)) {
+        return false;
+    }
+
+    if (channel_dispatcher::getUSet(channel) != step.voltage) {
+        channel_dispatcher::setVoltage(channel, step.voltage);
+    }
+
+    if (channel_dispatcher::getISet(channel) != step.current) {
+        channel_dispatcher::setCurrent(channel, step.current);
+    }
+
+    return true;
+}
+
+static uint64_t getTime(uint32_t tick_usec) {
+    // tick_usec can be a little bit behind if execution was started in the same PSU tick
+    int32_t diff = (int32_t)(tick_usec - g_lastTickUsec);
+    if (diff > 0) {
+        g_time += diff;
+        g_lastTickUsec = tick_usec;
+    }
+    return g_time;
+}
+
 void executionStart(Channel &channel) {
-    g_execution[channel.channelIndex].it = -1;
-    g_execution[channel.channelIndex].counter = g_channelsLists[channel.channelIndex].count;
+    int err;
+    if (isStreamed(channel) ? !streamStart(channel, &err) : !compile(channel, &err)) {
+        generateError(err);
+        setActive(false);
+        trigger::abort();
+        return;
+    }
+
+    auto &execution = g_execution[channel.channelIndex];
+    execution.it = -1;
+    execution.lastInFile = false;
+    execution.counter = g_channelsLists[channel.channelIndex].count;
+
+    // first step is applied immediately, all the following deadlines are counted from here
+    uint32_t tick_usec = micros();
+    execution.nextPointTime = getTime(tick_usec);
+    execution.lastTime = execution.nextPointTime;
+
+    execution.numAppliedSteps = 0;
+    execution.maxLateness = 0;
+    execution.totalLateness = 0;
+
     setActive(true, true);
 
-    tick(micros());
+    tick(tick_usec);
+}
+
+void getStatistics(Channel &channel, uint32_t &numSteps, float &avgLateness, float &maxLateness) {
+    auto &execution = g_execution[channel.channelIndex];
+    numSteps = execution.numAppliedSteps;
+    avgLateness = numSteps > 0 ? (float)(execution.totalLateness / numSteps) / 1000000.0f : 0;
+    maxLateness = execution.maxLateness / 1000000.0f;
 }
 
 int maxListsSize(Channel &channel) {
@@ -520,40 +660,33 @@ int maxListsSize(Channel &channel) {
 }
 
 bool setListValue(Channel &channel, int16_t it, int *err) {
-    float voltage = g_channelsLists[channel.channelIndex].voltageList[it % g_channelsLists[channel.channelIndex].voltageListLength];
-    if (voltage > channel_dispatcher::getULimit(channel)) {
-        *err = SCPI_ERROR_VOLTAGE_LIMIT_EXCEEDED;
-        return false;
-    }
-
-    float current = g_channelsLists[channel.channelIndex].currentList[it % g_channelsLists[channel.channelIndex].currentListLength];
-    if (current > channel_dispatcher::getILimit(channel)) {
-        *err = SCPI_ERROR_CURRENT_LIMIT_EXCEEDED;
-        return false;
-    }
+    ListStep step;
 
-    if (voltage * current > channel_dispatcher::getPowerLimit(channel)) {
-        *err = SCPI_ERROR_POWER_LIMIT_EXCEEDED;
-        return false;
-    }
-
-    if (channel_dispatcher::getUSet(channel) != voltage) {
-        channel_dispatcher::setVoltage(channel, voltage);
-    }
-
-    if (channel_dispatcher::getISet(channel) != current) {
-        channel_dispatcher::setCurrent(channel, current);
+    if (isStreamed(channel)) {
+        // only the first and the last executed step are known
+        if (!getStreamStep(channel, it == 0, step)) {
+            *err = SCPI_ERROR_CANNOT_SET_LIST_VALUE;
+            return false;
+        }
+    } else {
+        auto &channelLists = g_channelsLists[channel.channelIndex];
+        step.voltage = channelLists.voltageList[it % channelLists.voltageListLength];
+        step.current = channelLists.currentList[it % channelLists.currentListLength];
+        step.dwell = 0;
     }
 
-    return true;
+    return setStep(channel, step, err);
 }
 
 void tick(uint32_t tick_usec) {
     bool active = false;
 
+    uint64_t time = getTime(tick_usec);
+
     for (int i = 0; i < CH_NUM; ++i) {
         Channel &channel = Channel::get(i);
-        if (g_execution[i].counter >= 0) {
+        auto &execution = g_execution[i];
+        if (execution.counter >= 0) {
             if (channel_dispatcher::isTripped(channel)) {
                 setActive(false);
                 trigger::abort();
@@ -562,65 +695,67 @@ void tick(uint32_t tick_usec) {
 
             active = true;
 
-            uint32_t tickCount;
-            if (g_execution[i].currentTotalDwellTime > CONF_COUNTER_THRESHOLD_IN_SECONDS) {
-                tickCount = millis();
-            } else {
-                tickCount = tick_usec;
-            }
-
             if (io_pins::isInhibited()) {
-                if (g_execution[i].it != -1) {
-                    g_execution[i].nextPointTime += tickCount - g_execution[i].lastTickCount;
-                }
+                execution.nextPointTime += time - execution.lastTime;
             } else {
-                bool set = false;
-
-                if (g_execution[i].it == -1) {
-                    set = true;
-                } else {
-                    g_execution[i].currentRemainingDwellTime = g_execution[i].nextPointTime - tickCount;
-                    if (g_execution[i].currentRemainingDwellTime <= 0) {
-                        set = true;
+                int64_t remaining = (int64_t)(execution.nextPointTime - time);
+                execution.currentRemainingDwellTime = (int32_t)(remaining / 1000);
+
+                if (remaining <= 0) {
+                    bool streamed = isStreamed(channel);
+
+                    bool endOfList;
+                    if (streamed) {
+                        endOfList = execution.lastInFile;
+                        execution.it = 0;
+                    } else {
+                        endOfList = ++execution.it == execution.numSteps;
                     }
-                }
 
-                if (set) {
-                    if (++g_execution[i].it == maxListsSize(channel)) {
-                        if (g_execution[i].counter > 0) {
-                            if (--g_execution[i].counter == 0) {
-                                g_execution[i].counter = -1;
+                    if (endOfList) {
+                        if (execution.counter > 0) {
+                            if (--execution.counter == 0) {
+                                execution.counter = -1;
+                                streamStop(channel);
                                 trigger::setTriggerFinished(channel);
                                 return;
                             }
                         }
 
-                        g_execution[i].it = 0;
+                        execution.it = 0;
                     }
 
+                    ListStep step;
                     int err;
-                    if (!setListValue(channel, g_execution[i].it, &err)) {
+                    bool success;
+                    if (streamed) {
+                        success = streamNextStep(channel, step, execution.lastInFile, &err) && setStep(channel, step, &err);
+                    } else {
+                        step = getSteps(i)[execution.it];
+                        success = setStep(channel, step, &err);
+                    }
+
+                    if (!success) {
                         generateError(err);
                         setActive(false);
                         trigger::abort();
                         return;
                     }
 
-                    g_execution[i].currentTotalDwellTime = g_channelsLists[i] .dwellList[g_execution[i].it % g_channelsLists[i].dwellListLength];
-                    // if dwell time is greater then CONF_COUNTER_THRESHOLD_IN_SECONDS ...
-                    if (g_execution[i].currentTotalDwellTime > CONF_COUNTER_THRESHOLD_IN_SECONDS) {
-                        // ... then count in milliseconds
-                        g_execution[i].currentRemainingDwellTime = (uint32_t)round(g_execution[i].currentTotalDwellTime * 1000L);
-                        g_execution[i].nextPointTime = millis() + g_execution[i].currentRemainingDwellTime;
-                    } else {
-                        // ... else count in microseconds
-                        g_execution[i].currentRemainingDwellTime = (uint32_t)round(g_execution[i].currentTotalDwellTime * 1000000L);
-                        g_execution[i].nextPointTime = tick_usec + g_execution[i].currentRemainingDwellTime;
+                    uint32_t lateness = (uint32_t)MIN(time - execution.nextPointTime, UINT32_MAX);
+                    execution.numAppliedSteps++;
+                    execution.totalLateness += lateness;
+                    if (lateness > execution.maxLateness) {
+                        execution.maxLateness = lateness;
                     }
+
+                    execution.currentTotalDwellTime = step.dwell / 1000000.0f;
+                    execution.nextPointTime += step.dwell;
+                    execution.currentRemainingDwellTime = (int32_t)((int64_t)(execution.nextPointTime - time) / 1000);
                 }
             }
 
-            g_execution[i].lastTickCount = tickCount;
+            execution.lastTime = time;
         }
     }
 
@@ -673,11 +808,7 @@ bool getCurrentDwellTime(Channel &channel, int32_t &remaining, uint32_t &total)
     int i = channel.flags.trackingEnabled ? getFirstTrackingChannel() : channel.channelIndex;
     if (g_execution[i].counter >= 0) {
         total = (uint32_t)ceilf(g_execution[i].currentTotalDwellTime);
-        if (g_execution[i].currentTotalDwellTime > CONF_COUNTER_THRESHOLD_IN_SECONDS) {
-            remaining = (uint32_t)ceil(g_execution[i].currentRemainingDwellTime / 1000L);
-        } else {
-            remaining = (uint32_t)ceil(g_execution[i].currentRemainingDwellTime / 1000000L);
-        }
+        remaining = g_execution[i].currentRemainingDwellTime / 1000;
         return true;
     }
     return false;
@@ -688,6 +819,7 @@ void abort() {
     for (int i = 0; i < CH_NUM; ++i) {
         if (g_execution[i].counter >= 0) {
             g_execution[i].counter = -1;
+            streamStop(Channel::get(i));
             channel_dispatcher::outputEnableOnNextSync(Channel::get(i), false);
             sync = true;
         }
@@ -18,6 +18,8 @@
  
 #pragma once
 
+#include <eez/modules/psu/list_csv.h>
+
 #define LIST_EXT ".list"
 
 namespace eez {
@@ -35,6 +37,14 @@ class BufferedFileWrite;
 
 namespace list {
 
+// List step compiled from the dwell, voltage and current lists when execution is started,
+// so tick doesn't have to wrap list indexes and convert dwell time.
+struct ListStep {
+    float voltage;
+    float current;
+    uint64_t dwell; // in microseconds
+};
+
 void init();
 
 void resetChannelList(Channel &channel);
@@ -101,6 +111,10 @@ bool saveList(int iChannel, const char *filePath, int *err);
 
 void executionStart(Channel &channel);
 
+// Steps applied since the last execution start, and how late (in seconds) they were
+// applied compared to their deadlines.
+void getStatistics(Channel &channel, uint32_t &numSteps, float &avgLateness, float &maxLateness);
+
 int maxListsSize(Channel &channel);
 
 bool setListValue(Channel &channel, int16_t it, int *err);
@@ -0,0 +1,341 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <eez/modules/psu/psu.h>
+#include <eez/libs/sd_fat/sd_fat.h>
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include <atomic>
+
+#include <scpi/scpi.h>
+
+#include <eez/scpi/scpi.h>
+#include <eez/memory.h>
+#include <eez/spsc_ring.h>
+
+#include <eez/modules/psu/list_program.h>
+#include <eez/modules/psu/list_stream.h>
+#include <eez/modules/psu/sd_card.h>
+
+namespace eez {
+
+using namespace scpi;
+
+namespace psu {
+namespace list {
+
+struct StreamStep {
+    ListStep step;
+    bool lastInFile;
+};
+
+static_assert(CH_MAX * LIST_STREAM_RING_SIZE * sizeof(StreamStep) <= LIST_STREAM_BUFFER_SIZE, "LIST_STREAM_BUFFER is too small");
+
+// publish parsed steps to the PSU thread in chunks, not only at the end of the fill
+static const uint32_t PUBLISH_CHUNK_SIZE = 64;
+
+struct Stream {
+    // stream file is set, cleared by the PSU thread on reset
+    std::atomic<bool> enabled;
+
+    // ring is filled from the start of the file and the steps can be taken by the PSU thread
+    std::atomic<bool> ready;
+
+    std::atomic<bool> restartRequested;
+    std::atomic<bool> closeRequested;
+    std::atomic<bool> messagePending;
+
+    // error while reading the file, reported by the PSU thread when ring gets empty
+    std::atomic<int> error;
+
+    SpscRing<StreamStep> ring;
+
+    // accessed only from the PSU thread
+    bool firstStepValid;
+    ListStep firstStep;
+    ListStep lastStep;
+
+    // accessed only from the SCPI thread
+    char filePath[MAX_PATH_LENGTH + 1];
+    File file;
+    bool fileIsOpen;
+    sd_card::BufferedFileRead reader { file };
+};
+
+static Stream g_streams[CH_MAX];
+
+static int getError(Stream &stream, int defaultError) {
+    int error = stream.error;
+    return error ? error : defaultError;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SCPI thread
+
+static bool isEndOfFile(sd_card::BufferedFileRead &file) {
+    sd_card::matchZeroOrMoreSpaces(file);
+    return !file.available() || file.peek() == '`';
+}
+
+// returns 0 or the SCPI error
+static int parseStep(sd_card::BufferedFileRead &file, ListStep &step) {
+    sd_card::matchZeroOrMoreSpaces(file);
+
+    const char *row;
+    size_t rowLength;
+    if (!file.readLine(row, rowLength)) {
+        // file is rewound after the last row, so there is nothing to read only if the file is empty
+        return file.isReadError() ? SCPI_ERROR_MASS_STORAGE_ERROR : SCPI_ERROR_LIST_IS_EMPTY;
+    }
+
+    if (file.isReadError()) {
+        // row could be cut short by the read error
+        return SCPI_ERROR_MASS_STORAGE_ERROR;
+    }
+
+    if (file.isLineTooLong()) {
+        return SCPI_ERROR_INVALID_LIST_STREAM_ROW;
+    }
+
+    float values[3];
+    if (!parseListRow(row, rowLength, values)) {
+        return SCPI_ERROR_INVALID_LIST_STREAM_ROW;
+    }
+
+    float dwell = values[0];
+    if (isNaN(dwell) || isNaN(values[1]) || isNaN(values[2]) || dwell < LIST_DWELL_MIN || dwell > LIST_DWELL_MAX) {
+        return SCPI_ERROR_INVALID_LIST_STREAM_ROW;
+    }
+
+    step.voltage = values[1];
+    step.current = values[2];
+    step.dwell = (uint64_t)round(dwell * 1000000.0);
+
+    return 0;
+}
+
+static void fill(Stream &stream) {
+    if (stream.error) {
+        return;
+    }
+
+    while (stream.ring.getFreeSpace() > 0) {
+        StreamStep item;
+
+        int error = parseStep(stream.reader, item.step);
+        if (error) {
+            stream.error = error;
+            break;
+        }
+
+        item.lastInFile = isEndOfFile(stream.reader);
+        if (item.lastInFile) {
+            stream.reader.rewind();
+        }
+
+        stream.ring.write(&item, 1);
+
+        if (stream.ring.getNumUnpublished() == PUBLISH_CHUNK_SIZE) {
+            stream.ring.publish();
+        }
+    }
+
+    stream.ring.publish();
+}
+
+// Ring is reset here, in the producer thread. PSU thread is the consumer and it doesn't access
+// the ring while ready is false (it is cleared before restart is requested or close is called),
+// reset indexes are visible to it after ready is set again.
+static void restart(Stream &stream) {
+    assert(!stream.ready);
+    stream.ring.reset();
+    stream.error = 0;
+    stream.reader.rewind();
+
+    fill(stream);
+
+    stream.ready = stream.ring.getAvailable() > 0;
+}
+
+static void close(Stream &stream) {
+    stream.enabled = false;
+    stream.ready = false;
+    stream.filePath[0] = 0;
+
+    if (stream.fileIsOpen) {
+        stream.file.close();
+        stream.fileIsOpen = false;
+    }
+}
+
+bool setStreamFile(Channel &channel, const char *filePath, int *err) {
+    int channelIndex = channel.channelIndex;
+    Stream &stream = g_streams[channelIndex];
+
+    close(stream);
+
+    if (!*filePath) {
+        return true;
+    }
+
+    if (!sd_card::isMounted(err)) {
+        return false;
+    }
+
+    if (!sd_card::exists(filePath, err)) {
+        if (err) {
+            *err = SCPI_ERROR_FILE_NOT_FOUND;
+        }
+        return false;
+    }
+
+    if (!stream.file.open(filePath, FILE_OPEN_EXISTING | FILE_READ)) {
+        if (err) {
+            *err = SCPI_ERROR_MASS_STORAGE_ERROR;
+        }
+        return false;
+    }
+
+    stream.fileIsOpen = true;
+
+    stream.ring.init((StreamStep *)LIST_STREAM_BUFFER + channelIndex * LIST_STREAM_RING_SIZE, LIST_STREAM_RING_SIZE);
+    restart(stream);
+
+    // check the first rows now, so invalid file is not reported only when list is triggered
+    if (stream.error || !stream.ready) {
+        if (err) {
+            *err = getError(stream, SCPI_ERROR_LIST_IS_EMPTY);
+        }
+        close(stream);
+        return false;
+    }
+
+    strcpy(stream.filePath, filePath);
+    stream.enabled = true;
+
+    return true;
+}
+
+const char *getStreamFile(Channel &channel) {
+    Stream &stream = g_streams[channel.channelIndex];
+    return stream.enabled ? stream.filePath : "";
+}
+
+void onStreamQueueMessage(int channelIndex) {
+    Stream &stream = g_streams[channelIndex];
+
+    stream.messagePending = false;
+
+    if (stream.closeRequested) {
+        stream.closeRequested = false;
+        close(stream);
+    } else if (stream.restartRequested) {
+        stream.restartRequested = false;
+        restart(stream);
+    } else if (stream.ready) {
+        fill(stream);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PSU thread
+
+static void postMessage(int channelIndex) {
+    // there is no need to queue another message if previous one is not processed yet
+    if (!g_streams[channelIndex].messagePending.exchange(true)) {
+        osMessagePut(g_scpiMessageQueueId, SCPI_QUEUE_MESSAGE(SCPI_QUEUE_MESSAGE_TARGET_NONE, SCPI_QUEUE_MESSAGE_TYPE_LIST_STREAM, channelIndex), osWaitForever);
+    }
+}
+
+bool isStreamed(Channel &channel) {
+    return g_streams[channel.channelIndex].enabled;
+}
+
+bool streamStart(Channel &channel, int *err) {
+    Stream &stream = g_streams[channel.channelIndex];
+
+    if (!stream.ready) {
+        *err = getError(stream, SCPI_ERROR_LIST_STREAM_UNDERRUN);
+        return false;
+    }
+
+    stream.firstStepValid = false;
+
+    return true;
+}
+
+bool streamNextStep(Channel &channel, ListStep &step, bool &lastInFile, int *err) {
+    Stream &stream = g_streams[channel.channelIndex];
+
+    const StreamStep *items;
+    if (!stream.ready || stream.ring.peek(items) == 0) {
+        *err = getError(stream, SCPI_ERROR_LIST_STREAM_UNDERRUN);
+        return false;
+    }
+
+    step = items->step;
+    lastInFile = items->lastInFile;
+    stream.ring.commit(1);
+
+    if (!stream.firstStepValid) {
+        stream.firstStep = step;
+        stream.firstStepValid = true;
+    }
+    stream.lastStep = step;
+
+    if (stream.ring.getAvailable() <= LIST_STREAM_RING_SIZE / 2) {
+        postMessage(channel.channelIndex);
+    }
+
+    return true;
+}
+
+void streamStop(Channel &channel) {
+    Stream &stream = g_streams[channel.channelIndex];
+    if (stream.enabled) {
+        stream.ready = false;
+        stream.restartRequested = true;
+        postMessage(channel.channelIndex);
+    }
+}
+
+void streamReset(Channel &channel) {
+    Stream &stream = g_streams[channel.channelIndex];
+    if (stream.enabled) {
+        stream.enabled = false;
+        stream.ready = false;
+        stream.closeRequested = true;
+        postMessage(channel.channelIndex);
+    }
+}
+
+bool getStreamStep(Channel &channel, bool first, ListStep &step) {
+    Stream &stream = g_streams[channel.channelIndex];
+    if (!stream.firstStepValid) {
+        return false;
+    }
+    step = first ? stream.firstStep : stream.lastStep;
+    return true;
+}
+
+} // namespace list
+} // namespace psu
+} // namespace eez
@@ -0,0 +1,68 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <eez/modules/psu/list_program.h>
+
+/* Streamed List
+
+Instead of taking the steps from the dwell/voltage/current lists, which are limited to
+MAX_LIST_LENGTH, steps are read from the CSV file on the SD card while the list is executing,
+so the number of steps is limited only by the file size. File has the same format as the one
+used by MMEMory:LOAD:LIST, but every row must have all three values: dwell, voltage and current.
+
+Rows are parsed by the SCPI thread into the ring of LIST_STREAM_RING_SIZE steps (LIST_STREAM_BUFFER)
+and consumed by list::tick in the PSU thread. Ring is filled completely when the file is set and
+after every execution, so the first steps are always ready when the list is triggered. During the
+execution SCPI thread is asked to fill it again every time it is half empty. If the step is due and
+the ring is empty, execution is aborted with the "List stream underrun" error. File read error
+("Mass storage error") or invalid row ("Invalid list stream row") is reported at the same point.
+
+List COUNT repeats the whole file.
+*/
+
+namespace eez {
+namespace psu {
+namespace list {
+
+static const uint32_t LIST_STREAM_RING_SIZE = 1024;
+
+// called from the SCPI thread
+
+// Empty file path stops streaming and the channel lists are used again.
+bool setStreamFile(Channel &channel, const char *filePath, int *err);
+const char *getStreamFile(Channel &channel);
+
+void onStreamQueueMessage(int channelIndex);
+
+// called from the PSU thread
+
+bool isStreamed(Channel &channel);
+
+bool streamStart(Channel &channel, int *err);
+bool streamNextStep(Channel &channel, ListStep &step, bool &lastInFile, int *err);
+void streamStop(Channel &channel);
+void streamReset(Channel &channel);
+
+// first or last step taken from the stream in the last execution
+bool getStreamStep(Channel &channel, bool first, ListStep &step);
+
+} // namespace list
+} // namespace psu
+} // namespace eez
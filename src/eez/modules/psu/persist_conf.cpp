@@ -1354,6 +1354,8 @@ void loadChannelCalibration(Channel &channel) {
         CH_CAL_CONF_VERSION
     )) {
         channel.clearCalibrationConf();
+    } else {
+        channel.updateCalibrationCoefficients();
     }
 }
 
@@ -209,6 +209,9 @@ void oneIter() {
     	uint32_t message = event.value.v;
     	uint32_t type = PSU_QUEUE_MESSAGE_TYPE(message);
     	uint32_t param = PSU_QUEUE_MESSAGE_PARAM(message);
+
+        channel_dispatcher::applySetpoints(PSU_QUEUE_MESSAGE_SETPOINT_SEQUENCE(message));
+
         if (type == PSU_QUEUE_MESSAGE_TYPE_CHANGE_POWER_STATE) {
             changePowerState(param ? true : false);
         } else if (type == PSU_QUEUE_MESSAGE_TYPE_RESET) {
@@ -241,10 +244,6 @@ void oneIter() {
             restart();
         } else if (type == PSU_QUEUE_MESSAGE_TYPE_SHUTDOWN) {
             shutdown();
-        } else if (type == PSU_QUEUE_MESSAGE_TYPE_SET_VOLTAGE) {
-            channel_dispatcher::setVoltageInPsuThread((int)param);
-        } else if (type == PSU_QUEUE_MESSAGE_TYPE_SET_CURRENT) {
-            channel_dispatcher::setCurrentInPsuThread((int)param);
         }
     } else if (g_isBooted) {
         tick();
@@ -650,12 +649,16 @@ void tick() {
 
     uint32_t tickCount = micros();
 
+    channel_dispatcher::applySetpoints();
+
     dlog_record::tick(tickCount);
 
     for (int i = 0; i < CH_NUM; ++i) {
         Channel::get(i).tick(tickCount);
     }
 
+    channel_dispatcher::updateChannelSnapshots(tickCount);
+
     io_pins::tick(tickCount);
 
     trigger::tick(tickCount);
@@ -59,6 +59,10 @@ void startThread();
 extern osThreadId g_psuTaskHandle;
 extern osMessageQId g_psuMessageQueueId;
 
+namespace channel_dispatcher {
+uint32_t getSetpointSequence();
+}
+
 #define PSU_QUEUE_MESSAGE_TYPE_CHANGE_POWER_STATE 1
 #define PSU_QUEUE_MESSAGE_TYPE_RESET 2
 #define PSU_QUEUE_MESSAGE_SPI_IRQ 3
@@ -73,12 +77,14 @@ extern osMessageQId g_psuMessageQueueId;
 #define PSU_QUEUE_SYNC_OUTPUT_ENABLE 11
 #define PSU_QUEUE_MESSAGE_TYPE_HARD_RESET 12
 #define PSU_QUEUE_MESSAGE_TYPE_SHUTDOWN 13
-#define PSU_QUEUE_MESSAGE_TYPE_SET_VOLTAGE 14
-#define PSU_QUEUE_MESSAGE_TYPE_SET_CURRENT 15
 
-#define PSU_QUEUE_MESSAGE(type, param) (((param) << 4) | (type))
+// Message also carries low bits of the setpoint sequence at the time it was posted, so voltage
+// and current set after the message was posted are not applied before the message is handled.
+#define PSU_QUEUE_MESSAGE_SETPOINT_SEQUENCE_MASK 0xFFF
+#define PSU_QUEUE_MESSAGE(type, param) ((eez::psu::channel_dispatcher::getSetpointSequence() << 20) | (((param) & 0xFFFF) << 4) | (type))
 #define PSU_QUEUE_MESSAGE_TYPE(message) ((message) & 0xF)
-#define PSU_QUEUE_MESSAGE_PARAM(param) ((message) >> 4)
+#define PSU_QUEUE_MESSAGE_PARAM(param) (((message) >> 4) & 0xFFFF)
+#define PSU_QUEUE_MESSAGE_SETPOINT_SEQUENCE(message) ((message) >> 20)
 
 bool measureAllAdcValuesOnChannel(int channelIndex);
 
@@ -16,6 +16,8 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <float.h>
+
 #include <eez/modules/psu/psu.h>
 
 #include <eez/modules/psu/scpi/psu.h>
@@ -229,6 +231,196 @@ scpi_result_t scpi_cmd_senseDlogTimeQ(scpi_t *context) {
     return SCPI_RES_OK;
 }
 
+scpi_result_t scpi_cmd_senseDlogCompression(scpi_t *context) {
+    if (!dlog_record::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    bool enable;
+    if (!SCPI_ParamBool(context, &enable, TRUE)) {
+        return SCPI_RES_ERR;
+    }
+
+    dlog_record::g_parameters.compression = enable;
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogCompressionQ(scpi_t *context) {
+    SCPI_ResultBool(context, dlog_record::g_parameters.compression);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogFunctionTimestamp(scpi_t *context) {
+    if (!dlog_record::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    bool enable;
+    if (!SCPI_ParamBool(context, &enable, TRUE)) {
+        return SCPI_RES_ERR;
+    }
+
+    dlog_record::g_parameters.logTimestamp = enable;
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogFunctionTimestampQ(scpi_t *context) {
+    SCPI_ResultBool(context, dlog_record::g_parameters.logTimestamp);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandState(scpi_t *context) {
+    if (!dlog_record::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    bool enable;
+    if (!SCPI_ParamBool(context, &enable, TRUE)) {
+        return SCPI_RES_ERR;
+    }
+
+    dlog_record::g_parameters.deadband.enabled = enable;
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandStateQ(scpi_t *context) {
+    SCPI_ResultBool(context, dlog_record::g_parameters.deadband.enabled);
+    return SCPI_RES_OK;
+}
+
+static bool getDeadbandThreshold(scpi_t *context, float maxValue, float &value) {
+    if (!dlog_record::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return false;
+    }
+
+    if (!SCPI_ParamFloat(context, &value, true)) {
+        return false;
+    }
+
+    if (value < 0 || value > maxValue) {
+        SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return false;
+    }
+
+    return true;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandAbsolute(scpi_t *context) {
+    float value;
+    if (!getDeadbandThreshold(context, FLT_MAX, value)) {
+        return SCPI_RES_ERR;
+    }
+
+    dlog_record::g_parameters.deadband.absolute = value;
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandAbsoluteQ(scpi_t *context) {
+    SCPI_ResultFloat(context, dlog_record::g_parameters.deadband.absolute);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandRelative(scpi_t *context) {
+    float value;
+    if (!getDeadbandThreshold(context, 100.0f, value)) {
+        return SCPI_RES_ERR;
+    }
+
+    dlog_record::g_parameters.deadband.relative = value;
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandRelativeQ(scpi_t *context) {
+    SCPI_ResultFloat(context, dlog_record::g_parameters.deadband.relative);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandInterval(scpi_t *context) {
+    if (!dlog_record::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    scpi_number_t param;
+    if (!SCPI_ParamNumber(context, scpi_special_numbers_def, &param, true)) {
+        return SCPI_RES_ERR;
+    }
+
+    float interval;
+
+    if (param.special) {
+        if (param.content.tag == SCPI_NUM_MIN) {
+            interval = dlog_record::DEADBAND_MAX_INTERVAL_MIN;
+        } else if (param.content.tag == SCPI_NUM_MAX) {
+            interval = dlog_record::DEADBAND_MAX_INTERVAL_MAX;
+        } else if (param.content.tag == SCPI_NUM_DEF) {
+            interval = dlog_record::DEADBAND_MAX_INTERVAL_DEFAULT;
+        } else {
+            SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+            return SCPI_RES_ERR;
+        }
+    } else {
+        if (param.unit != SCPI_UNIT_NONE && param.unit != SCPI_UNIT_SECOND) {
+            SCPI_ErrorPush(context, SCPI_ERROR_INVALID_SUFFIX);
+            return SCPI_RES_ERR;
+        }
+
+        interval = (float)param.content.value;
+
+        if (interval < dlog_record::DEADBAND_MAX_INTERVAL_MIN || interval > dlog_record::DEADBAND_MAX_INTERVAL_MAX) {
+            SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+            return SCPI_RES_ERR;
+        }
+    }
+
+    dlog_record::g_parameters.deadband.maxInterval = interval;
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogDeadbandIntervalQ(scpi_t *context) {
+    SCPI_ResultFloat(context, dlog_record::g_parameters.deadband.maxInterval);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogStatisticsQ(scpi_t *context) {
+    dlog_record::Statistics statistics;
+    dlog_record::getStatistics(statistics);
+
+    if (statistics.numIntervals == 0) {
+        SCPI_ResultFloat(context, 0);
+        SCPI_ResultFloat(context, 0);
+        SCPI_ResultFloat(context, 0);
+    } else {
+        SCPI_ResultFloat(context, statistics.minInterval * 1E-6f);
+        SCPI_ResultFloat(context, (float)(statistics.sumIntervals / statistics.numIntervals) * 1E-6f);
+        SCPI_ResultFloat(context, statistics.maxInterval * 1E-6f);
+    }
+    SCPI_ResultFloat(context, dlog_record::getIntervalPercentile(statistics, 99.0f));
+    SCPI_ResultUInt32(context, statistics.numMissedSamples);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseDlogStatisticsHistogramQ(scpi_t *context) {
+    dlog_record::Statistics statistics;
+    dlog_record::getStatistics(statistics);
+
+    SCPI_ResultFloat(context, statistics.binWidth * 1E-6f);
+    SCPI_ResultArrayUInt32(context, statistics.histogram, dlog_record::Statistics::NUM_HISTOGRAM_BINS, SCPI_FORMAT_ASCII);
+
+    return SCPI_RES_OK;
+}
+
 scpi_result_t scpi_cmd_senseDlogTraceComment(scpi_t *context) {
     if (!dlog_record::isIdle()) {
         SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
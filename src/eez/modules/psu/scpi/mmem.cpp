@@ -29,6 +29,10 @@
 #include <eez/modules/psu/trigger.h>
 
 #include <eez/modules/psu/sd_card.h>
+#include <eez/modules/psu/serial_psu.h>
+#if OPTION_ETHERNET
+#include <eez/modules/psu/ethernet.h>
+#endif
 
 #if OPTION_DISPLAY
 #include <eez/modules/psu/gui/psu.h>
@@ -216,6 +220,63 @@ scpi_result_t scpi_cmd_mmemoryUploadQ(scpi_t *context) {
     return SCPI_RES_OK;
 }
 
+static uint32_t getUploadChunkMaxSize(scpi_t *context) {
+#if OPTION_ETHERNET
+    if (context == &ethernet::g_scpiContext) {
+        return CONF_UPLOAD_CHUNK_MAX_SIZE_ETHERNET;
+    }
+#endif
+    return CONF_UPLOAD_CHUNK_MAX_SIZE_SERIAL;
+}
+
+scpi_result_t scpi_cmd_mmemoryUploadChunkQ(scpi_t *context) {
+    char filePath[MAX_PATH_LENGTH + 1];
+    if (!getFilePath(context, filePath, true)) {
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t offset;
+    if (!SCPI_ParamUInt32(context, &offset, true)) {
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t length;
+    if (!SCPI_ParamUInt32(context, &length, true)) {
+        return SCPI_RES_ERR;
+    }
+
+    // host can check the actual length from the block header
+    uint32_t maxSize = getUploadChunkMaxSize(context);
+    if (length > maxSize) {
+        length = maxSize;
+    }
+
+    uint32_t crc;
+    int err;
+    if (!sd_card::uploadChunk(filePath, offset, length, context, uploadCallback, &crc, &err)) {
+        if (err != 0) {
+            SCPI_ErrorPush(context, err);
+        }
+        return SCPI_RES_ERR;
+    }
+
+    // CRC is always sent after the block, it is the CRC of the sent bytes,
+    // so the host must check the error queue to detect a read error
+    SCPI_ResultUInt32(context, crc);
+
+    if (err != 0) {
+        SCPI_ErrorPush(context, err);
+        return SCPI_RES_ERR;
+    }
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_mmemoryUploadChunkMaximumQ(scpi_t *context) {
+    SCPI_ResultUInt32(context, getUploadChunkMaxSize(context));
+    return SCPI_RES_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static char g_downloadFilePath[MAX_PATH_LENGTH + 1];
@@ -159,6 +159,60 @@ scpi_result_t scpi_cmd_senseCurrentDcRangeAutoQ(scpi_t *context) {
     return SCPI_RES_OK;
 }
 
+scpi_result_t scpi_cmd_senseAverageCount(scpi_t *context) {
+    scpi_number_t param;
+    if (!SCPI_ParamNumber(context, scpi_special_numbers_def, &param, true)) {
+        return SCPI_RES_ERR;
+    }
+
+    int32_t numValues;
+
+    if (param.special) {
+        if (param.content.tag == SCPI_NUM_MIN) {
+            numValues = 1;
+        } else if (param.content.tag == SCPI_NUM_MAX) {
+            numValues = NUM_ADC_AVERAGING_VALUES_MAX;
+        } else if (param.content.tag == SCPI_NUM_DEF) {
+            numValues = NUM_ADC_AVERAGING_VALUES;
+        } else {
+            SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+            return SCPI_RES_ERR;
+        }
+    } else {
+        if (param.unit != SCPI_UNIT_NONE) {
+            SCPI_ErrorPush(context, SCPI_ERROR_INVALID_SUFFIX);
+            return SCPI_RES_ERR;
+        }
+
+        numValues = (int32_t)param.content.value;
+
+        if (numValues != param.content.value || numValues < 1 || numValues > NUM_ADC_AVERAGING_VALUES_MAX) {
+            SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+            return SCPI_RES_ERR;
+        }
+    }
+
+    Channel *channel = param_channel(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    channel_dispatcher::setAdcAveragingNumValues(*channel, (uint8_t)numValues);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_senseAverageCountQ(scpi_t *context) {
+    Channel *channel = param_channel(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    SCPI_ResultInt(context, channel->adcAveragingNumValues);
+
+    return SCPI_RES_OK;
+}
+
 } // namespace scpi
 } // namespace psu
 } // namespace eez
@@ -21,6 +21,7 @@
 #include <eez/modules/psu/channel_dispatcher.h>
 #include <eez/modules/psu/io_pins.h>
 #include <eez/modules/psu/list_program.h>
+#include <eez/modules/psu/list_stream.h>
 #include <eez/modules/psu/profile.h>
 #include <eez/modules/psu/scpi/psu.h>
 #include <eez/modules/psu/trigger.h>
@@ -871,6 +872,120 @@ scpi_result_t scpi_cmd_sourceVoltageModeQ(scpi_t *context) {
     return SCPI_RES_OK;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// List limits are checked in the same way for the text and the binary form of the list commands.
+
+static bool checkVoltageList(scpi_t *context, Channel &channel, const float *voltageList, uint16_t voltageListLength, const float *currentList, uint16_t currentListLength) {
+    float uMaxLimit = channel_dispatcher::getUMaxLimit(channel);
+    float powerMaxLimit = channel_dispatcher::getPowerMaxLimit(channel);
+
+    for (int i = 0; i < voltageListLength; ++i) {
+        if (voltageList[i] > uMaxLimit) {
+            SCPI_ErrorPush(context, SCPI_ERROR_VOLTAGE_LIMIT_EXCEEDED);
+            return false;
+        }
+
+        if (currentListLength > 0) {
+            if (voltageList[i] * currentList[i % currentListLength] > powerMaxLimit) {
+                SCPI_ErrorPush(context, SCPI_ERROR_POWER_LIMIT_EXCEEDED);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool checkCurrentList(scpi_t *context, Channel &channel, const float *currentList, uint16_t currentListLength, const float *voltageList, uint16_t voltageListLength) {
+    float iMaxLimit = channel_dispatcher::getIMaxLimit(channel);
+    float powerMaxLimit = channel_dispatcher::getPowerMaxLimit(channel);
+
+    for (int i = 0; i < currentListLength; ++i) {
+        if (currentList[i] > iMaxLimit) {
+            SCPI_ErrorPush(context, SCPI_ERROR_CURRENT_LIMIT_EXCEEDED);
+            return false;
+        }
+
+        if (voltageListLength > 0) {
+            if (currentList[i] * voltageList[i % voltageListLength] > powerMaxLimit) {
+                SCPI_ErrorPush(context, SCPI_ERROR_POWER_LIMIT_EXCEEDED);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool checkDwellList(scpi_t *context, const float *dwellList, uint16_t dwellListLength) {
+    for (int i = 0; i < dwellListLength; ++i) {
+        if (dwellList[i] < LIST_DWELL_MIN || dwellList[i] > LIST_DWELL_MAX) {
+            SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Binary form of the list is IEEE 488.2 definite length block with numColumns little-endian
+// float32 values per list point. Block data is not aligned, so values are copied one by one.
+static bool getListBlock(scpi_t *context, const char *&block, int numColumns, uint16_t &listLength) {
+    size_t size;
+    if (!SCPI_ParamArbitraryBlock(context, &block, &size, true)) {
+        return false;
+    }
+
+    size_t pointSize = numColumns * sizeof(float);
+
+    if (size == 0) {
+        SCPI_ErrorPush(context, SCPI_ERROR_MISSING_PARAMETER);
+        return false;
+    }
+
+    if (size % pointSize != 0) {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_BLOCK_DATA);
+        return false;
+    }
+
+    if (size / pointSize > MAX_LIST_LENGTH) {
+        SCPI_ErrorPush(context, SCPI_ERROR_TOO_MANY_LIST_POINTS);
+        return false;
+    }
+
+    listLength = (uint16_t)(size / pointSize);
+
+    return true;
+}
+
+static bool getListBlockValue(scpi_t *context, const char *block, int index, float &value) {
+    // both STM32 and simulator are little-endian
+    memcpy(&value, block + index * sizeof(float), sizeof(float));
+
+    if (isNaN(value) || isinf(value)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return false;
+    }
+
+    return true;
+}
+
+static bool getListBlock(scpi_t *context, float *list, uint16_t &listLength) {
+    const char *block;
+    if (!getListBlock(context, block, 1, listLength)) {
+        return false;
+    }
+
+    for (int i = 0; i < listLength; ++i) {
+        if (!getListBlockValue(context, block, i, list[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 scpi_result_t scpi_cmd_sourceListCount(scpi_t *context) {
     Channel *channel = set_channel_from_command_number(context);
     if (!channel) {
@@ -936,10 +1051,7 @@ scpi_result_t scpi_cmd_sourceListCurrentLevel(scpi_t *context) {
     float list[MAX_LIST_LENGTH];
     uint16_t listLength = 0;
 
-    uint16_t voltageListLength;
-    float *voltageList = list::getCurrentList(*channel, &voltageListLength);
-
-    for (int i = 0;; ++i) {
+    while (true) {
         scpi_number_t param;
         if (!SCPI_ParamNumber(context, 0, &param, false)) {
             break;
@@ -957,18 +1069,6 @@ scpi_result_t scpi_cmd_sourceListCurrentLevel(scpi_t *context) {
             return SCPI_RES_ERR;
         }
 
-        if (current > channel_dispatcher::getIMaxLimit(*channel)) {
-            SCPI_ErrorPush(context, SCPI_ERROR_CURRENT_LIMIT_EXCEEDED);
-            return SCPI_RES_ERR;
-        }
-
-        if (voltageListLength > 0) {
-            if (current * voltageList[i % voltageListLength] > channel_dispatcher::getPowerMaxLimit(*channel)) {
-                SCPI_ErrorPush(context, SCPI_ERROR_POWER_LIMIT_EXCEEDED);
-                return SCPI_RES_ERR;
-            }
-        }
-
         list[listLength++] = current;
     }
 
@@ -977,6 +1077,42 @@ scpi_result_t scpi_cmd_sourceListCurrentLevel(scpi_t *context) {
         return SCPI_RES_ERR;
     }
 
+    uint16_t voltageListLength;
+    float *voltageList = list::getVoltageList(*channel, &voltageListLength);
+
+    if (!checkCurrentList(context, *channel, list, listLength, voltageList, voltageListLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!trigger::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    channel_dispatcher::setCurrentList(*channel, list, listLength);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_sourceListCurrentLevelBinary(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    float list[MAX_LIST_LENGTH];
+    uint16_t listLength;
+    if (!getListBlock(context, list, listLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    uint16_t voltageListLength;
+    float *voltageList = list::getVoltageList(*channel, &voltageListLength);
+
+    if (!checkCurrentList(context, *channel, list, listLength, voltageList, voltageListLength)) {
+        return SCPI_RES_ERR;
+    }
+
     if (!trigger::isIdle()) {
         SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
         return SCPI_RES_ERR;
@@ -1045,6 +1181,32 @@ scpi_result_t scpi_cmd_sourceListDwell(scpi_t *context) {
     return SCPI_RES_OK;
 }
 
+scpi_result_t scpi_cmd_sourceListDwellBinary(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    float list[MAX_LIST_LENGTH];
+    uint16_t listLength;
+    if (!getListBlock(context, list, listLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!checkDwellList(context, list, listLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!trigger::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    channel_dispatcher::setDwellList(*channel, list, listLength);
+
+    return SCPI_RES_OK;
+}
+
 scpi_result_t scpi_cmd_sourceListDwellQ(scpi_t *context) {
     Channel *channel = set_channel_from_command_number(context);
     if (!channel) {
@@ -1058,6 +1220,139 @@ scpi_result_t scpi_cmd_sourceListDwellQ(scpi_t *context) {
     return SCPI_RES_OK;
 }
 
+scpi_result_t scpi_cmd_sourceListStatisticsQ(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t numSteps;
+    float avgLateness;
+    float maxLateness;
+    list::getStatistics(*channel, numSteps, avgLateness, maxLateness);
+
+    SCPI_ResultUInt32(context, numSteps);
+    SCPI_ResultFloat(context, avgLateness);
+    SCPI_ResultFloat(context, maxLateness);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_sourceListStream(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!trigger::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    char filePath[MAX_PATH_LENGTH + 1];
+    if (!getFilePath(context, filePath, true)) {
+        return SCPI_RES_ERR;
+    }
+
+    int err;
+    if (!list::setStreamFile(*channel, filePath, &err)) {
+        SCPI_ErrorPush(context, err);
+        return SCPI_RES_ERR;
+    }
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_sourceListStreamQ(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    const char *filePath = list::getStreamFile(*channel);
+    SCPI_ResultText(context, filePath);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_sourceListStreamClear(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!trigger::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    list::setStreamFile(*channel, "", nullptr);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_sourceListTableBinary(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    // dwell, voltage and current of each list point
+    const char *block;
+    uint16_t listLength;
+    if (!getListBlock(context, block, 3, listLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    float dwellList[MAX_LIST_LENGTH];
+    float voltageList[MAX_LIST_LENGTH];
+    float currentList[MAX_LIST_LENGTH];
+
+    float uMaxLimit = channel_dispatcher::getUMaxLimit(*channel);
+    float iMaxLimit = channel_dispatcher::getIMaxLimit(*channel);
+    float powerMaxLimit = channel_dispatcher::getPowerMaxLimit(*channel);
+
+    for (int i = 0; i < listLength; ++i) {
+        if (
+            !getListBlockValue(context, block, 3 * i, dwellList[i]) ||
+            !getListBlockValue(context, block, 3 * i + 1, voltageList[i]) ||
+            !getListBlockValue(context, block, 3 * i + 2, currentList[i])
+        ) {
+            return SCPI_RES_ERR;
+        }
+
+        if (!checkDwellList(context, dwellList + i, 1)) {
+            return SCPI_RES_ERR;
+        }
+
+        if (voltageList[i] > uMaxLimit) {
+            SCPI_ErrorPush(context, SCPI_ERROR_VOLTAGE_LIMIT_EXCEEDED);
+            return SCPI_RES_ERR;
+        }
+
+        if (currentList[i] > iMaxLimit) {
+            SCPI_ErrorPush(context, SCPI_ERROR_CURRENT_LIMIT_EXCEEDED);
+            return SCPI_RES_ERR;
+        }
+
+        if (voltageList[i] * currentList[i] > powerMaxLimit) {
+            SCPI_ErrorPush(context, SCPI_ERROR_POWER_LIMIT_EXCEEDED);
+            return SCPI_RES_ERR;
+        }
+    }
+
+    if (!trigger::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    channel_dispatcher::setDwellList(*channel, dwellList, listLength);
+    channel_dispatcher::setVoltageList(*channel, voltageList, listLength);
+    channel_dispatcher::setCurrentList(*channel, currentList, listLength);
+
+    return SCPI_RES_OK;
+}
+
 scpi_result_t scpi_cmd_sourceListVoltageLevel(scpi_t *context) {
     Channel *channel = set_channel_from_command_number(context);
     if (!channel) {
@@ -1067,10 +1362,7 @@ scpi_result_t scpi_cmd_sourceListVoltageLevel(scpi_t *context) {
     float list[MAX_LIST_LENGTH];
     uint16_t listLength = 0;
 
-    uint16_t currentListLength;
-    float *currentList = list::getCurrentList(*channel, &currentListLength);
-
-    for (int i = 0;; ++i) {
+    while (true) {
         scpi_number_t param;
         if (!SCPI_ParamNumber(context, 0, &param, false)) {
             break;
@@ -1088,18 +1380,6 @@ scpi_result_t scpi_cmd_sourceListVoltageLevel(scpi_t *context) {
             return SCPI_RES_ERR;
         }
 
-        if (voltage > channel_dispatcher::getUMaxLimit(*channel)) {
-            SCPI_ErrorPush(context, SCPI_ERROR_VOLTAGE_LIMIT_EXCEEDED);
-            return SCPI_RES_ERR;
-        }
-
-        if (currentListLength > 0) {
-            if (voltage * currentList[i % currentListLength] > channel_dispatcher::getPowerMaxLimit(*channel)) {
-                SCPI_ErrorPush(context, SCPI_ERROR_POWER_LIMIT_EXCEEDED);
-                return SCPI_RES_ERR;
-            }
-        }
-
         list[listLength++] = voltage;
     }
 
@@ -1108,6 +1388,42 @@ scpi_result_t scpi_cmd_sourceListVoltageLevel(scpi_t *context) {
         return SCPI_RES_ERR;
     }
 
+    uint16_t currentListLength;
+    float *currentList = list::getCurrentList(*channel, &currentListLength);
+
+    if (!checkVoltageList(context, *channel, list, listLength, currentList, currentListLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    if (!trigger::isIdle()) {
+        SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
+        return SCPI_RES_ERR;
+    }
+
+    channel_dispatcher::setVoltageList(*channel, list, listLength);
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t scpi_cmd_sourceListVoltageLevelBinary(scpi_t *context) {
+    Channel *channel = set_channel_from_command_number(context);
+    if (!channel) {
+        return SCPI_RES_ERR;
+    }
+
+    float list[MAX_LIST_LENGTH];
+    uint16_t listLength;
+    if (!getListBlock(context, list, listLength)) {
+        return SCPI_RES_ERR;
+    }
+
+    uint16_t currentListLength;
+    float *currentList = list::getCurrentList(*channel, &currentListLength);
+
+    if (!checkVoltageList(context, *channel, list, listLength, currentList, currentListLength)) {
+        return SCPI_RES_ERR;
+    }
+
     if (!trigger::isIdle()) {
         SCPI_ErrorPush(context, SCPI_ERROR_CANNOT_CHANGE_TRANSIENT_TRIGGER);
         return SCPI_RES_ERR;
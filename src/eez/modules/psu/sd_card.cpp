@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -316,6 +317,69 @@ bool upload(const char *filePath, void *param, void (*callback)(void *param, con
     return result;
 }
 
+// Sends up to length bytes of the file starting from offset (less if the end of the file is reached)
+// and calculates CRC-32 of the sent data. Progress page is not shown, because host will usually
+// send many of these requests for the single file.
+// Returns false if nothing is sent. If the file read fails after the block header is sent,
+// the rest of the block is filled with zeros, true is returned and *err is set.
+bool uploadChunk(const char *filePath, uint32_t offset, uint32_t length, void *param, void (*callback)(void *param, const void *buffer, int size), uint32_t *crc, int *err) {
+    if (!sd_card::isMounted(err)) {
+        return false;
+    }
+
+    File file;
+    if (!file.open(filePath, FILE_OPEN_EXISTING | FILE_READ)) {
+        if (err)
+            *err = SCPI_ERROR_FILE_NAME_NOT_FOUND;
+        return false;
+    }
+
+    size_t totalSize = file.size();
+    if (offset > totalSize || !file.seek(offset)) {
+        file.close();
+        if (err)
+            *err = SCPI_ERROR_DATA_OUT_OF_RANGE;
+        return false;
+    }
+
+    if (length > totalSize - offset) {
+        length = totalSize - offset;
+    }
+
+    if (err)
+        *err = SCPI_RES_OK;
+
+    *crc = 0;
+
+    callback(param, NULL, length);
+
+    const int CHUNK_SIZE = CONF_SERIAL_BUFFER_SIZE;
+    uint8_t buffer[CHUNK_SIZE];
+
+    while (length > 0) {
+        int size = file.read(buffer, MIN(length, (uint32_t)CHUNK_SIZE));
+        if (size <= 0) {
+            // header with the length is already sent, so the rest of the block is filled with zeros
+            memset(buffer, 0, CHUNK_SIZE);
+            size = MIN(length, (uint32_t)CHUNK_SIZE);
+            if (err)
+                *err = SCPI_ERROR_MASS_STORAGE_ERROR;
+        }
+
+        *crc = crc32Update(*crc, buffer, size);
+
+        callback(param, buffer, size);
+
+        length -= size;
+    }
+
+    file.close();
+
+    callback(param, NULL, -1);
+
+    return true;
+}
+
 bool download(const char *filePath, bool truncate, const void *buffer, size_t size, int *err) {
     if (!sd_card::isMounted(err)) {
         return false;
@@ -581,18 +645,30 @@ bool getInfo(uint64_t &usedSpace, uint64_t &freeSpace, bool fromCache) {
 
 BufferedFileRead::BufferedFileRead(File &file_)
     : file(file_)
-    , position(BUFFER_SIZE)
-    , end(BUFFER_SIZE)
+    , position(0)
+    , end(0)
+    , eof(false)
+    , readError(false)
+    , lineTooLong(false)
 {
 }
 
 void BufferedFileRead::readNextChunk() {
-    if (position == end && end == BUFFER_SIZE) {
+    if (position == end && !eof) {
         position = 0;
         end = file.read(buffer, BUFFER_SIZE);
+        if (end < BUFFER_SIZE) {
+            setEof();
+        }
     }
 }
 
+void BufferedFileRead::setEof() {
+    eof = true;
+    // File::read returns less than requested also on error
+    readError = file.tell() < file.size();
+}
+
 int BufferedFileRead::peek() {
     readNextChunk();
     return position < end ? buffer[position] : -1;
@@ -632,6 +708,54 @@ size_t BufferedFileRead::tell() {
     return file.tell();
 }
 
+void BufferedFileRead::rewind() {
+    file.seek(0);
+    position = 0;
+    end = 0;
+    eof = false;
+    readError = false;
+    lineTooLong = false;
+}
+
+bool BufferedFileRead::readLine(const char *&line, size_t &length) {
+    readNextChunk();
+    if (position == end) {
+        return false;
+    }
+
+    uint8_t *lineEnd = (uint8_t *)memchr(buffer + position, '\n', end - position);
+
+    if (!lineEnd && !eof && position > 0) {
+        // move the start of the line to the beginning of the buffer and read the rest of it
+        end -= position;
+        memmove(buffer, buffer + position, end);
+        position = 0;
+
+        size_t n = file.read(buffer + end, BUFFER_SIZE - end);
+        if (end + n < BUFFER_SIZE) {
+            setEof();
+        }
+
+        lineEnd = (uint8_t *)memchr(buffer + end, '\n', n);
+        end += n;
+    }
+
+    line = (const char *)buffer + position;
+
+    if (lineEnd) {
+        length = lineEnd - (buffer + position);
+        position += length + 1;
+    } else {
+        length = end - position;
+        position = end;
+    }
+
+    // without '\n' the line is complete only if it is the last one in the file
+    lineTooLong = !lineEnd && !eof;
+
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BufferedFileWrite::BufferedFileWrite(File &file_)
@@ -53,6 +53,7 @@ bool exists(const char *dirPath, int *err);
 bool catalog(const char *dirPath, void *param, void (*callback)(void *param, const char *name, FileType type, size_t size), int *numFiles, int *err);
 bool catalogLength(const char *dirPath, size_t *length, int *err);
 bool upload(const char *filePath, void *param, void (*callback)(void *param, const void *buffer, int size), int *err);
+bool uploadChunk(const char *filePath, uint32_t offset, uint32_t length, void *param, void (*callback)(void *param, const void *buffer, int size), uint32_t *crc, int *err);
 bool download(const char *filePath, bool truncate, const void *buffer, size_t size, int *err);
 void downloadFinished();
 bool moveFile(const char *sourcePath, const char *destinationPath, int *err);
@@ -80,14 +81,31 @@ public:
     size_t size();
     size_t tell();
 
+    // continue reading from the start of the file
+    void rewind();
+
+    // Returns the next line (without '\n') directly from the buffer, so it can be scanned as a
+    // whole instead of character by character. Lines longer than the buffer are returned in parts.
+    bool readLine(const char *&line, size_t &length);
+
+    // line returned by the last readLine is only the first part of the line longer than the buffer
+    bool isLineTooLong() { return lineTooLong; }
+
+    // reading stopped before the end of the file because of the read error
+    bool isReadError() { return readError; }
+
 private:
     File &file;
     static const size_t BUFFER_SIZE = 512;
     uint8_t buffer[BUFFER_SIZE];
     size_t position;
     size_t end;
+    bool eof;
+    bool readError;
+    bool lineTooLong;
 
     void readNextChunk();
+    void setEof();
 };
 
 class BufferedFileWrite {
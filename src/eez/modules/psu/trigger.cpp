@@ -21,6 +21,7 @@
 #include <eez/modules/psu/channel_dispatcher.h>
 #include <eez/modules/psu/io_pins.h>
 #include <eez/modules/psu/list_program.h>
+#include <eez/modules/psu/list_stream.h>
 #include <eez/modules/psu/persist_conf.h>
 #include <eez/modules/psu/profile.h>
 #include <eez/modules/psu/trigger.h>
@@ -247,17 +248,20 @@ int checkTrigger() {
             }
 
             if (channel.getVoltageTriggerMode() == TRIGGER_MODE_LIST) {
-                if (list::isListEmpty(channel)) {
-                    return SCPI_ERROR_LIST_IS_EMPTY;
-                }
-
-                if (!list::areListLengthsEquivalent(channel)) {
-                    return SCPI_ERROR_LIST_LENGTHS_NOT_EQUIVALENT;
-                }
-
-                int err = list::checkLimits(i);
-                if (err) {
-                    return err;
+                // steps of the streamed list are checked when they are executed
+                if (!list::isStreamed(channel)) {
+                    if (list::isListEmpty(channel)) {
+                        return SCPI_ERROR_LIST_IS_EMPTY;
+                    }
+
+                    if (!list::areListLengthsEquivalent(channel)) {
+                        return SCPI_ERROR_LIST_LENGTHS_NOT_EQUIVALENT;
+                    }
+
+                    int err = list::checkLimits(i);
+                    if (err) {
+                        return err;
+                    }
                 }
             } else {
                 if (g_levels[i].u > channel_dispatcher::getULimit(channel)) {
@@ -178,6 +178,13 @@ osStatus osMessagePut(osMessageQId queue_id, uint32_t info, uint32_t millisec) {
     return osOK; 
 }
 
+uint32_t osMessageWaiting(osMessageQId queue_id) {
+    if (queue_id->overflow) {
+        return queue_id->numElements;
+    }
+    return (queue_id->head + queue_id->numElements - queue_id->tail) % queue_id->numElements;
+}
+
 Mutex *osMutexCreate(Mutex &mutex) {
     return &mutex;
 }
@@ -110,6 +110,8 @@
     SCPI_COMMAND("MMEMory:TIME?", scpi_cmd_mmemoryTimeQ) \
     SCPI_COMMAND("MMEMory:UNLock", scpi_cmd_mmemoryUnlock) \
     SCPI_COMMAND("MMEMory:UPLoad?", scpi_cmd_mmemoryUploadQ) \
+    SCPI_COMMAND("MMEMory:UPLoad:CHUNk?", scpi_cmd_mmemoryUploadChunkQ) \
+    SCPI_COMMAND("MMEMory:UPLoad:CHUNk:MAXimum?", scpi_cmd_mmemoryUploadChunkMaximumQ) \
     SCPI_COMMAND("OUTPut:DPRog", scpi_cmd_outputDprog) \
     SCPI_COMMAND("OUTPut:DPRog?", scpi_cmd_outputDprogQ) \
     SCPI_COMMAND("OUTPut:MODE?", scpi_cmd_outputModeQ) \
@@ -122,18 +124,34 @@
     SCPI_COMMAND("OUTPut[:STATe]:TRIGgered", scpi_cmd_outputStateTriggered) \
     SCPI_COMMAND("OUTPut[:STATe]:TRIGgered?", scpi_cmd_outputStateTriggeredQ) \
     SCPI_COMMAND("OUTPut[:STATe]?", scpi_cmd_outputStateQ) \
+    SCPI_COMMAND("SENSe:AVERage:COUNt", scpi_cmd_senseAverageCount) \
+    SCPI_COMMAND("SENSe:AVERage:COUNt?", scpi_cmd_senseAverageCountQ) \
     SCPI_COMMAND("SENSe:CURRent[:DC]:RANGe:AUTO", scpi_cmd_senseCurrentDcRangeAuto) \
     SCPI_COMMAND("SENSe:CURRent[:DC]:RANGe:AUTO?", scpi_cmd_senseCurrentDcRangeAutoQ) \
     SCPI_COMMAND("SENSe:CURRent[:DC]:RANGe[:UPPer]", scpi_cmd_senseCurrentDcRangeUpper) \
     SCPI_COMMAND("SENSe:CURRent[:DC]:RANGe[:UPPer]?", scpi_cmd_senseCurrentDcRangeUpperQ) \
+    SCPI_COMMAND("SENSe:DLOG:COMPression", scpi_cmd_senseDlogCompression) \
+    SCPI_COMMAND("SENSe:DLOG:COMPression?", scpi_cmd_senseDlogCompressionQ) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband[:STATe]", scpi_cmd_senseDlogDeadbandState) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband[:STATe]?", scpi_cmd_senseDlogDeadbandStateQ) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband:ABSolute", scpi_cmd_senseDlogDeadbandAbsolute) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband:ABSolute?", scpi_cmd_senseDlogDeadbandAbsoluteQ) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband:RELative", scpi_cmd_senseDlogDeadbandRelative) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband:RELative?", scpi_cmd_senseDlogDeadbandRelativeQ) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband:INTerval", scpi_cmd_senseDlogDeadbandInterval) \
+    SCPI_COMMAND("SENSe:DLOG:DEADband:INTerval?", scpi_cmd_senseDlogDeadbandIntervalQ) \
     SCPI_COMMAND("SENSe:DLOG:FUNCtion:CURRent", scpi_cmd_senseDlogFunctionCurrent) \
     SCPI_COMMAND("SENSe:DLOG:FUNCtion:CURRent?", scpi_cmd_senseDlogFunctionCurrentQ) \
     SCPI_COMMAND("SENSe:DLOG:FUNCtion:POWer", scpi_cmd_senseDlogFunctionPower) \
     SCPI_COMMAND("SENSe:DLOG:FUNCtion:POWer?", scpi_cmd_senseDlogFunctionPowerQ) \
+    SCPI_COMMAND("SENSe:DLOG:FUNCtion:TIMEstamp", scpi_cmd_senseDlogFunctionTimestamp) \
+    SCPI_COMMAND("SENSe:DLOG:FUNCtion:TIMEstamp?", scpi_cmd_senseDlogFunctionTimestampQ) \
     SCPI_COMMAND("SENSe:DLOG:FUNCtion:VOLTage", scpi_cmd_senseDlogFunctionVoltage) \
     SCPI_COMMAND("SENSe:DLOG:FUNCtion:VOLTage?", scpi_cmd_senseDlogFunctionVoltageQ) \
     SCPI_COMMAND("SENSe:DLOG:PERiod", scpi_cmd_senseDlogPeriod) \
     SCPI_COMMAND("SENSe:DLOG:PERiod?", scpi_cmd_senseDlogPeriodQ) \
+    SCPI_COMMAND("SENSe:DLOG:STATistics?", scpi_cmd_senseDlogStatisticsQ) \
+    SCPI_COMMAND("SENSe:DLOG:STATistics:HISTogram?", scpi_cmd_senseDlogStatisticsHistogramQ) \
     SCPI_COMMAND("SENSe:DLOG:TIME", scpi_cmd_senseDlogTime) \
     SCPI_COMMAND("SENSe:DLOG:TIME?", scpi_cmd_senseDlogTimeQ) \
     SCPI_COMMAND("SENSe:DLOG:TRACe:X:UNIT", scpi_cmd_senseDlogTraceXUnit) \
@@ -179,10 +197,18 @@
     SCPI_COMMAND("[SOURce#]:LIST:COUNt?", scpi_cmd_sourceListCountQ) \
     SCPI_COMMAND("[SOURce#]:LIST:CURRent[:LEVel]", scpi_cmd_sourceListCurrentLevel) \
     SCPI_COMMAND("[SOURce#]:LIST:CURRent[:LEVel]?", scpi_cmd_sourceListCurrentLevelQ) \
+    SCPI_COMMAND("[SOURce#]:LIST:CURRent[:LEVel]:BINary", scpi_cmd_sourceListCurrentLevelBinary) \
     SCPI_COMMAND("[SOURce#]:LIST:DWELl", scpi_cmd_sourceListDwell) \
     SCPI_COMMAND("[SOURce#]:LIST:DWELl?", scpi_cmd_sourceListDwellQ) \
+    SCPI_COMMAND("[SOURce#]:LIST:DWELl:BINary", scpi_cmd_sourceListDwellBinary) \
+    SCPI_COMMAND("[SOURce#]:LIST:STATistics?", scpi_cmd_sourceListStatisticsQ) \
+    SCPI_COMMAND("[SOURce#]:LIST:STReam", scpi_cmd_sourceListStream) \
+    SCPI_COMMAND("[SOURce#]:LIST:STReam?", scpi_cmd_sourceListStreamQ) \
+    SCPI_COMMAND("[SOURce#]:LIST:STReam:CLEar", scpi_cmd_sourceListStreamClear) \
+    SCPI_COMMAND("[SOURce#]:LIST:TABLe:BINary", scpi_cmd_sourceListTableBinary) \
     SCPI_COMMAND("[SOURce#]:LIST:VOLTage[:LEVel]", scpi_cmd_sourceListVoltageLevel) \
     SCPI_COMMAND("[SOURce#]:LIST:VOLTage[:LEVel]?", scpi_cmd_sourceListVoltageLevelQ) \
+    SCPI_COMMAND("[SOURce#]:LIST:VOLTage[:LEVel]:BINary", scpi_cmd_sourceListVoltageLevelBinary) \
     SCPI_COMMAND("[SOURce#]:POWer:LIMit", scpi_cmd_sourcePowerLimit) \
     SCPI_COMMAND("[SOURce#]:POWer:LIMit?", scpi_cmd_sourcePowerLimitQ) \
     SCPI_COMMAND("[SOURce#]:POWer:PROTection:DELay[:TIME]", scpi_cmd_sourcePowerProtectionDelayTime) \
@@ -29,6 +29,7 @@
 #include <eez/modules/psu/psu.h>
 #include <eez/modules/psu/channel_dispatcher.h>
 #include <eez/modules/psu/list_program.h>
+#include <eez/modules/psu/list_stream.h>
 #include <eez/modules/psu/serial_psu.h>
 #if OPTION_ETHERNET
 #include <eez/modules/psu/ethernet.h>
@@ -135,7 +136,10 @@ void oneIter() {
                 if (!eez::psu::list::saveList(param, &g_listFilePath[param][0], &err)) {
                     generateError(err);
                 }
+            } else if (type == SCPI_QUEUE_MESSAGE_TYPE_LIST_STREAM) {
+                eez::psu::list::onStreamQueueMessage(param);
             } else if (type == SCPI_QUEUE_MESSAGE_TYPE_SHUTDOWN) {
+                eez::psu::dlog_view::shutdown();
                 g_shutingDown = true;
             }
 #if defined(EEZ_PLATFORM_STM32)
@@ -152,6 +156,10 @@ void oneIter() {
                 eez::psu::dlog_view::openFile(nullptr);
             } else if (type == SCPI_QUEUE_MESSAGE_DLOG_LOAD_BLOCK) {
                 eez::psu::dlog_view::loadBlock();
+            } else if (type == SCPI_QUEUE_MESSAGE_DLOG_LOAD_JOBS_FINISHED) {
+                eez::psu::dlog_view::onLoadJobsFinished();
+            } else if (type == SCPI_QUEUE_MESSAGE_DLOG_BUILD_INDEX) {
+                eez::psu::dlog_view::buildIndex();
             } else if (type == SCPI_QUEUE_MESSAGE_ABORT_DOWNLOADING) {
                 abortDownloading();
             } else if (type == SCPI_QUEUE_MESSAGE_SCREENSHOT) {
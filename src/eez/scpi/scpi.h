@@ -58,6 +58,7 @@ enum {
     SCPI_QUEUE_MESSAGE_TYPE_DLOG_STATE_TRANSITION,
     SCPI_QUEUE_MESSAGE_DLOG_SHOW_FILE,
     SCPI_QUEUE_MESSAGE_DLOG_LOAD_BLOCK,
+    SCPI_QUEUE_MESSAGE_DLOG_BUILD_INDEX,
     SCPI_QUEUE_MESSAGE_ABORT_DOWNLOADING,
     SCPI_QUEUE_MESSAGE_SCREENSHOT,
     SCPI_QUEUE_MESSAGE_TYPE_FILE_MANAGER_LOAD_DIRECTORY,
@@ -77,7 +78,9 @@ enum {
     SCPI_QUEUE_MESSAGE_TYPE_USER_PROFILES_PAGE_IMPORT,
     SCPI_QUEUE_MESSAGE_TYPE_USER_PROFILES_PAGE_EXPORT,
     SCPI_QUEUE_MESSAGE_TYPE_USER_PROFILES_PAGE_DELETE,
-    SCPI_QUEUE_MESSAGE_TYPE_USER_PROFILES_PAGE_EDIT_REMARK
+    SCPI_QUEUE_MESSAGE_TYPE_USER_PROFILES_PAGE_EDIT_REMARK,
+    SCPI_QUEUE_MESSAGE_TYPE_LIST_STREAM,
+    SCPI_QUEUE_MESSAGE_DLOG_LOAD_JOBS_FINISHED
 };
 
 extern char g_listFilePath[CH_MAX][MAX_PATH_LENGTH];
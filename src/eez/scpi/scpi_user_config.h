@@ -50,6 +50,7 @@ extern "C" {
 #define LIST_OF_USER_ERRORS \
     X(SCPI_ERROR_HEADER_SUFFIX_OUTOFRANGE,                  -114, "Header suffix out of range")                   \
     X(SCPI_ERROR_CHARACTER_DATA_TOO_LONG,                   -144, "Character data too long")                      \
+    X(SCPI_ERROR_INVALID_BLOCK_DATA,                        -161, "Invalid block data")                           \
     X(SCPI_ERROR_TRIGGER_IGNORED,                           -211, "Trigger ignored")                              \
     X(SCPI_ERROR_DATA_OUT_OF_RANGE,                         -222, "Data out of range")                            \
     X(SCPI_ERROR_TOO_MUCH_DATA,                             -223, "Too much data")                                \
@@ -128,6 +129,8 @@ extern "C" {
     X(SCPI_ERROR_EXECUTE_ERROR_CHANNELS_ARE_COUPLED,         312, "Cannot execute when the channels are coupled") \
     X(SCPI_ERROR_EXECUTE_ERROR_IN_TRACKING_MODE,             313, "Cannot execute in tracking mode")              \
     X(SCPI_ERROR_CANNOT_SET_LIST_VALUE,                      314, "Cannot set list value")                        \
+    X(SCPI_ERROR_LIST_STREAM_UNDERRUN,                       315, "List stream underrun")                         \
+    X(SCPI_ERROR_INVALID_LIST_STREAM_ROW,                    316, "Invalid list stream row")                      \
 	X(SCPI_ERROR_CANNOT_LOAD_EMPTY_PROFILE,                  400, "Cannot load empty profile")                    \
     X(SCPI_ERROR_PROFILE_MODULE_MISMATCH,                    401, "Module mismatch in profile")                   \
 	X(SCPI_ERROR_MASS_MEDIA_NO_FILESYSTEM,                   410, "No FAT file system on mass media")             \
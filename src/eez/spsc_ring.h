@@ -0,0 +1,165 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+namespace eez {
+
+/// Lock-free ring buffer for exactly one producer and one consumer thread.
+///
+/// Producer writes items and then publishes them, so the consumer never sees partially written
+/// data (e.g. half of the row). Consumer peeks at the published items and commits the ones it is
+/// done with, only then producer can overwrite them. Items are never removed from the memory,
+/// so the last consumed items can still be read with copyOut (if producer doesn't overwrite them).
+///
+/// Indexes are free running 32-bit counters, so capacity must be a power of 2. Memory for the
+/// items is given in init, so it can be placed in the external RAM.
+template <typename T>
+class SpscRing {
+public:
+    static const uint32_t CACHE_LINE_SIZE = 64;
+
+    void init(T *buffer, uint32_t capacity) {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        m_buffer = buffer;
+        m_mask = capacity - 1;
+        reset();
+    }
+
+    /// Must not be called while producer or consumer is using the ring. Caller is usually the
+    /// producer, then the consumer must be quiescent: it must not access the ring until it sees
+    /// an atomic flag (stored by the caller after reset) saying that the ring can be used again,
+    /// so the reset read index is visible to it.
+    void reset() {
+        m_writeIndex = 0;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t getCapacity() const {
+        return m_mask + 1;
+    }
+
+    /// Copies n items starting from the absolute index, wrap around is handled.
+    void copyOut(uint32_t index, T *items, uint32_t n) const {
+        uint32_t i = index & m_mask;
+        uint32_t n1 = n < getCapacity() - i ? n : getCapacity() - i;
+        memcpy(items, m_buffer + i, n1 * sizeof(T));
+        if (n1 < n) {
+            memcpy(items + n1, m_buffer, (n - n1) * sizeof(T));
+        }
+    }
+
+    // Producer side
+
+    /// Number of items that can be written without overwriting items that are not consumed yet.
+    uint32_t getFreeSpace() const {
+        return getCapacity() - (m_writeIndex - m_tail.load(std::memory_order_acquire));
+    }
+
+    /// Writes items, they are not visible to the consumer until publish.
+    /// Returns false, and nothing is written, if there is not enough free space.
+    bool write(const T *items, uint32_t n) {
+        if (n > getFreeSpace()) {
+            return false;
+        }
+        copyIn(m_writeIndex, items, n);
+        m_writeIndex += n;
+        return true;
+    }
+
+    /// Overwrites items that are written but not published yet.
+    void rewrite(uint32_t index, const T *items, uint32_t n) {
+        copyIn(index, items, n);
+    }
+
+    /// Makes all written items visible to the consumer.
+    void publish() {
+        m_head.store(m_writeIndex, std::memory_order_release);
+    }
+
+    bool push(const T *items, uint32_t n) {
+        if (!write(items, n)) {
+            return false;
+        }
+        publish();
+        return true;
+    }
+
+    uint32_t getWriteIndex() const {
+        return m_writeIndex;
+    }
+
+    uint32_t getNumUnpublished() const {
+        return m_writeIndex - m_head.load(std::memory_order_relaxed);
+    }
+
+    // Consumer side
+
+    uint32_t getReadIndex() const {
+        return m_tail.load(std::memory_order_relaxed);
+    }
+
+    /// Number of published items that are not consumed yet.
+    uint32_t getAvailable() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of available items that are contiguous in the memory
+    /// (up to the end of the buffer) and pointer to the first one.
+    uint32_t peek(const T *&items) const {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t available = m_head.load(std::memory_order_acquire) - tail;
+        uint32_t i = tail & m_mask;
+        items = m_buffer + i;
+        return available < getCapacity() - i ? available : getCapacity() - i;
+    }
+
+    /// Frees n items for the producer.
+    void commit(uint32_t n) {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+private:
+    T *m_buffer;
+    uint32_t m_mask;
+    uint32_t m_writeIndex; // accessed only by the producer
+
+    // head is written by the producer and tail by the consumer, so they are kept
+    // in separate cache lines
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_head;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_tail;
+    uint8_t m_tailPadding[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+
+    void copyIn(uint32_t index, const T *items, uint32_t n) {
+        uint32_t i = index & m_mask;
+        uint32_t n1 = n < getCapacity() - i ? n : getCapacity() - i;
+        memcpy(m_buffer + i, items, n1 * sizeof(T));
+        if (n1 < n) {
+            memcpy(m_buffer, items + n1, (n - n1) * sizeof(T));
+        }
+    }
+};
+
+} // namespace eez
@@ -149,6 +149,22 @@ uint32_t crc32(const uint8_t *mem_block, size_t block_size) {
 }
 #endif
 
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t size) {
+    // reflected polynomial 0xEDB88320, processed 4 bits at a time
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+    }
+    return ~crc;
+}
+
 uint8_t toBCD(uint8_t bin) {
     return ((bin / 10) << 4) | (bin % 10);
 }
@@ -260,6 +276,98 @@ void getParentDir(const char *path, char *parentDirPath) {
     parentDirPath[i] = 0;
 }
 
+static const double POWERS_OF_10[] = {
+    1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+    1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22
+};
+
+static double powerOf10(int exponent) {
+    if (exponent < (int)(sizeof(POWERS_OF_10) / sizeof(double))) {
+        return POWERS_OF_10[exponent];
+    }
+    return pow(10.0, exponent);
+}
+
+bool parseFloat(const char *&p, const char *end, float &result) {
+    const char *q = p;
+
+    bool isNegative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+        isNegative = *q == '-';
+        q++;
+    }
+
+    // digits that don't fit into the float precision are not added to the mantissa
+    uint32_t mantissa = 0;
+    int exponent = 0;
+    int numDigits = 0;
+    bool isFraction = false;
+
+    for (; q < end; q++) {
+        char c = *q;
+        if (c >= '0' && c <= '9') {
+            if (mantissa < 100000000) {
+                mantissa = mantissa * 10 + (c - '0');
+                if (isFraction) {
+                    exponent--;
+                }
+            } else if (!isFraction) {
+                exponent++;
+            }
+            numDigits++;
+        } else if (c == '.' && !isFraction) {
+            isFraction = true;
+        } else {
+            break;
+        }
+    }
+
+    if (numDigits == 0) {
+        return false;
+    }
+
+    if (q < end && (*q == 'e' || *q == 'E')) {
+        q++;
+
+        bool isExponentNegative = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            isExponentNegative = *q == '-';
+            q++;
+        }
+
+        if (q == end || *q < '0' || *q > '9') {
+            return false;
+        }
+
+        int value = 0;
+        for (; q < end && *q >= '0' && *q <= '9'; q++) {
+            if (value < 1000) {
+                value = value * 10 + (*q - '0');
+            }
+        }
+
+        exponent += isExponentNegative ? -value : value;
+    }
+
+    double value = mantissa;
+    if (exponent < 0) {
+        value /= powerOf10(-exponent);
+    } else if (exponent > 0) {
+        value *= powerOf10(exponent);
+    }
+
+    result = (float)(isNegative ? -value : value);
+
+    // value out of the float range (e.g. 1e999)
+    if (isNaN(result) || isinf(result)) {
+        return false;
+    }
+
+    p = q;
+
+    return true;
+}
+
 bool parseMacAddress(const char *macAddressStr, size_t macAddressStrLength, uint8_t *macAddress) {
     int state = 0;
     int a;
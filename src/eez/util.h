@@ -62,6 +62,10 @@ void strcatFloat(char *str, float value, int numDecimalPlaces);
 
 uint32_t crc32(const uint8_t *message, size_t size);
 
+// Standard CRC-32 (IEEE 802.3, the same as in zlib) calculated in software, so the result
+// is the same on all platforms. Start with crc 0 and pass the result for the next part.
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t size);
+
 uint8_t toBCD(uint8_t bin);
 uint8_t fromBCD(uint8_t bcd);
 
@@ -87,6 +91,9 @@ bool pointInsideRect(int xPoint, int yPoint, int xRect, int yRect, int wRect, in
 
 void getParentDir(const char *path, char *parentDirPath);
 
+// parses the number at p, p is moved after it
+bool parseFloat(const char *&p, const char *end, float &result);
+
 bool parseMacAddress(const char *macAddressStr, size_t macAddressStrLength, uint8_t *macAddress);
 
 int getIpAddressPartA(uint32_t ipAddress);
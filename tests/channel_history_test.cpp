@@ -0,0 +1,116 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <vector>
+
+#include <eez/modules/psu/channel_history.h>
+
+#include "test.h"
+
+// CHANNEL_HISTORY_BUFFER is in the simulated SDRAM
+uint8_t g_memory[64 * 1024 * 1024];
+
+using namespace eez::psu;
+
+// Samples are added to the history and every available point is compared with the min/max
+// computed directly from the samples it covers, for U, I and P = U * I.
+
+static const uint32_t NUM_SAMPLES = 200000;
+
+static std::vector<float> g_u;
+static std::vector<float> g_i;
+
+static uint32_t nextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static void checkRate(ChannelHistory &history, uint32_t rate, uint32_t samplesPerPoint) {
+    uint32_t numPoints = history.getNumPoints(rate);
+    CHECK(numPoints == g_u.size() / samplesPerPoint);
+
+    uint32_t numChecked = 0;
+    uint32_t numErrors = 0;
+    for (uint32_t pointIndex = 0; pointIndex < numPoints; pointIndex++) {
+        float uMin, uMax, iMin, iMax, pMin, pMax;
+        bool available = history.getPoint(pointIndex, rate, ChannelHistory::VALUE_TYPE_U, uMin, uMax);
+        if (!available) {
+            continue;
+        }
+        CHECK(history.getPoint(pointIndex, rate, ChannelHistory::VALUE_TYPE_I, iMin, iMax));
+        CHECK(history.getPoint(pointIndex, rate, ChannelHistory::VALUE_TYPE_P, pMin, pMax));
+
+        float expected[6] = { INFINITY, -INFINITY, INFINITY, -INFINITY, INFINITY, -INFINITY };
+        for (uint32_t j = pointIndex * samplesPerPoint; j < (pointIndex + 1) * samplesPerPoint; j++) {
+            float p = g_u[j] * g_i[j];
+            expected[0] = fminf(expected[0], g_u[j]);
+            expected[1] = fmaxf(expected[1], g_u[j]);
+            expected[2] = fminf(expected[2], g_i[j]);
+            expected[3] = fmaxf(expected[3], g_i[j]);
+            expected[4] = fminf(expected[4], p);
+            expected[5] = fmaxf(expected[5], p);
+        }
+
+        if (uMin != expected[0] || uMax != expected[1] || iMin != expected[2] || iMax != expected[3] || pMin != expected[4] || pMax != expected[5]) {
+            numErrors++;
+        }
+        numChecked++;
+    }
+
+    CHECK(numErrors == 0);
+
+    CHECK(numChecked > 0);
+
+    // point that is not complete yet
+    float min, max;
+    CHECK(!history.getPoint(numPoints, rate, ChannelHistory::VALUE_TYPE_U, min, max));
+}
+
+int main() {
+    static ChannelHistory history;
+    history.reset(0);
+
+    uint32_t random = 1;
+    for (uint32_t j = 0; j < NUM_SAMPLES; j++) {
+        // U and I are anti-correlated (CV/CC crossover), so the corner products of the U and I
+        // envelopes are not the real P envelope
+        float x = (nextRandom(random) % 10000) / 10000.0f;
+        float u = 1.0f + 9.0f * x;
+        float i = 1.0f - 0.9f * x + (nextRandom(random) % 100) / 10000.0f;
+        g_u.push_back(u);
+        g_i.push_back(i);
+        history.addValue(u, i);
+    }
+
+    const uint32_t BASE_PERIOD = ChannelHistory::BASE_PERIOD;
+
+    checkRate(history, BASE_PERIOD, 1);
+    checkRate(history, 2 * BASE_PERIOD, 2);
+    checkRate(history, 8 * BASE_PERIOD, 8);
+    checkRate(history, 24 * BASE_PERIOD, 24);
+    checkRate(history, 64 * BASE_PERIOD, 64);
+    checkRate(history, 128 * BASE_PERIOD, 128);
+
+    // raw samples that are overwritten are not available anymore
+    float min, max;
+    CHECK(!history.getPoint(0, BASE_PERIOD, ChannelHistory::VALUE_TYPE_U, min, max));
+    CHECK(history.getPoint(NUM_SAMPLES - 1, BASE_PERIOD, ChannelHistory::VALUE_TYPE_U, min, max));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,203 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include <eez/modules/psu/psu.h>
+
+#include <eez/modules/psu/dlog_codec.h>
+
+#include "test.h"
+
+using namespace eez::psu;
+using namespace eez::psu::dlog_codec;
+
+// Rows are encoded into as many blocks as needed, then all blocks are decoded and every value
+// is compared bit by bit with the original, so NaN, infinity and -0 must survive too.
+
+static const uint32_t NUM_COLUMNS = 7;
+static const uint32_t NUM_ROWS = 50000;
+
+static uint32_t nextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static void getRow(uint32_t rowIndex, uint32_t &random, float *values) {
+    for (uint32_t i = 0; i < NUM_COLUMNS; i++) {
+        float value;
+        if (i == 0) {
+            // timestamp like column
+            value = rowIndex * 0.001f;
+        } else if (i == 1) {
+            // mostly constant
+            value = (rowIndex / 1000) % 2 ? 5.0f : 12.0f;
+        } else if (i == 2) {
+            // noisy signal
+            value = 1.0f + (nextRandom(random) % 1000) / 100000.0f;
+        } else if (i == 3) {
+            // gaps in the recording
+            value = rowIndex % 97 < 10 ? NAN : sinf(rowIndex * 0.01f);
+        } else if (i == 4) {
+            // special values
+            static const float SPECIAL[] = { 0.0f, -0.0f, INFINITY, -INFINITY, 1E-40f, -3.4E38f, 1.0f };
+            value = SPECIAL[nextRandom(random) % (sizeof(SPECIAL) / sizeof(float))];
+        } else {
+            // random bits
+            uint32_t bits = nextRandom(random) ^ (nextRandom(random) << 16);
+            memcpy(&value, &bits, sizeof(float));
+        }
+        values[i] = value;
+    }
+}
+
+struct Block {
+    uint8_t data[BLOCK_SIZE];
+    uint32_t length;
+};
+
+static bool isSameValue(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+int main() {
+    std::vector<float> rows(NUM_ROWS * NUM_COLUMNS);
+    uint32_t random = 1;
+    for (uint32_t rowIndex = 0; rowIndex < NUM_ROWS; rowIndex++) {
+        getRow(rowIndex, random, &rows[rowIndex * NUM_COLUMNS]);
+    }
+
+    // encode
+    std::vector<Block> blocks;
+    static BlockEncoder encoder;
+    Block block;
+    encoder.start(block.data, NUM_COLUMNS, 0);
+    for (uint32_t rowIndex = 0; rowIndex < NUM_ROWS; rowIndex++) {
+        if (!encoder.addRow(&rows[rowIndex * NUM_COLUMNS])) {
+            CHECK(encoder.getNumRows() > 0);
+            block.length = encoder.finish();
+            CHECK(block.length <= BLOCK_SIZE);
+            blocks.push_back(block);
+
+            encoder.start(block.data, NUM_COLUMNS, rowIndex);
+            CHECK(encoder.addRow(&rows[rowIndex * NUM_COLUMNS]));
+        }
+    }
+    block.length = encoder.finish();
+    blocks.push_back(block);
+
+    CHECK(blocks.size() > 1);
+
+    // decode
+    static BlockDecoder decoder;
+    uint32_t numRows = 0;
+    uint32_t numErrors = 0;
+    for (size_t blockIndex = 0; blockIndex < blocks.size(); blockIndex++) {
+        CHECK(decoder.start(blocks[blockIndex].data, blocks[blockIndex].length, NUM_COLUMNS));
+        CHECK(decoder.getHeader().firstRow == numRows);
+
+        dlog_view::Range ranges[NUM_COLUMNS];
+        for (uint32_t i = 0; i < NUM_COLUMNS; i++) {
+            ranges[i].min = NAN;
+            ranges[i].max = NAN;
+        }
+
+        float values[NUM_COLUMNS];
+        while (decoder.readRow(values)) {
+            for (uint32_t i = 0; i < NUM_COLUMNS; i++) {
+                float value = rows[numRows * NUM_COLUMNS + i];
+                if (!isSameValue(values[i], value)) {
+                    numErrors++;
+                }
+                if (isnan(ranges[i].min) || value < ranges[i].min) {
+                    ranges[i].min = value;
+                }
+                if (isnan(ranges[i].max) || value > ranges[i].max) {
+                    ranges[i].max = value;
+                }
+            }
+            numRows++;
+        }
+
+        CHECK(decoder.getRowIndex() == decoder.getHeader().firstRow + decoder.getHeader().numRows);
+
+        // block ranges are the min/max of the values in the block
+        for (uint32_t i = 0; i < NUM_COLUMNS; i++) {
+            CHECK(isSameValue(decoder.getRanges()[i].min, ranges[i].min));
+            CHECK(isSameValue(decoder.getRanges()[i].max, ranges[i].max));
+        }
+    }
+
+    CHECK(numErrors == 0);
+    CHECK(numRows == NUM_ROWS);
+
+    // skipRows lands on the same row as readRow
+    {
+        const Block &block = blocks[blocks.size() / 2];
+        CHECK(decoder.start(block.data, block.length, NUM_COLUMNS));
+        uint32_t numSkipped = decoder.getHeader().numRows / 2;
+        CHECK(decoder.skipRows(numSkipped));
+        float values[NUM_COLUMNS];
+        CHECK(decoder.readRow(values));
+        uint32_t rowIndex = decoder.getHeader().firstRow + numSkipped;
+        for (uint32_t i = 0; i < NUM_COLUMNS; i++) {
+            CHECK(isSameValue(values[i], rows[rowIndex * NUM_COLUMNS + i]));
+        }
+        CHECK(!decoder.skipRows(decoder.getHeader().numRows));
+    }
+
+    // truncated block is rejected
+    CHECK(!decoder.start(blocks[0].data, blocks[0].length - 1, NUM_COLUMNS));
+    CHECK(!decoder.start(blocks[0].data, getBlockDataOffset(NUM_COLUMNS) - 1, NUM_COLUMNS));
+
+    // corrupted header is rejected
+    {
+        Block block = blocks[0];
+        uint16_t dataLength = BLOCK_SIZE;
+        memcpy(block.data + 6, &dataLength, sizeof(uint16_t));
+        CHECK(!decoder.start(block.data, BLOCK_SIZE, NUM_COLUMNS));
+
+        uint16_t numRows = 0;
+        block = blocks[0];
+        memcpy(block.data + 4, &numRows, sizeof(uint16_t));
+        CHECK(!decoder.start(block.data, BLOCK_SIZE, NUM_COLUMNS));
+    }
+
+    // corrupted data never reads past the block data
+    {
+        uint32_t state = 12345;
+        for (int n = 0; n < 1000; n++) {
+            Block block = blocks[n % blocks.size()];
+            uint32_t dataOffset = getBlockDataOffset(NUM_COLUMNS);
+            uint32_t bitPosition = nextRandom(state) % ((block.length - dataOffset) * 8);
+            block.data[dataOffset + bitPosition / 8] ^= 0x80 >> (bitPosition % 8);
+
+            CHECK(decoder.start(block.data, block.length, NUM_COLUMNS));
+            float values[NUM_COLUMNS];
+            uint32_t numRowsRead = 0;
+            while (decoder.readRow(values)) {
+                numRowsRead++;
+            }
+            CHECK(numRowsRead <= decoder.getHeader().numRows);
+        }
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include <eez/modules/psu/dlog_view_min_max.h>
+
+#include "test.h"
+
+using namespace eez::psu::dlog_view;
+
+// reduceMinMax (SSE2 or NEON when available) is compared with the plain loop for columns of
+// every length up to MAX_N and at every alignment, with and without NaN values (gaps).
+
+static const uint32_t MAX_N = 40;
+
+static uint32_t nextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static void reduceMinMaxScalar(const float *column, uint32_t n, float &min, float &max) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (column[i] < min) {
+            min = column[i];
+        }
+        if (column[i] > max) {
+            max = column[i];
+        }
+    }
+}
+
+int main() {
+    float buffer[MAX_N + 4];
+
+    uint32_t random = 1;
+    uint32_t numErrors = 0;
+    for (int iteration = 0; iteration < 2000; iteration++) {
+        // 0 - no NaN, 1 - some NaN, 2 - all NaN
+        int nanMode = iteration % 3;
+        for (uint32_t i = 0; i < MAX_N + 4; i++) {
+            if (nanMode == 2 || (nanMode == 1 && nextRandom(random) % 4 == 0)) {
+                buffer[i] = NAN;
+            } else {
+                buffer[i] = ((int)(nextRandom(random) % 20001) - 10000) / 100.0f;
+            }
+        }
+
+        for (uint32_t offset = 0; offset < 4; offset++) {
+            for (uint32_t n = 0; n <= MAX_N; n++) {
+                float min = INFINITY;
+                float max = -INFINITY;
+                reduceMinMax(buffer + offset, n, min, max);
+
+                float expectedMin = INFINITY;
+                float expectedMax = -INFINITY;
+                reduceMinMaxScalar(buffer + offset, n, expectedMin, expectedMax);
+
+                if (min != expectedMin || max != expectedMax) {
+                    numErrors++;
+                }
+
+                // min/max from the previous rows are kept
+                min = -1000.0f;
+                max = 1000.0f;
+                reduceMinMax(buffer + offset, n, min, max);
+                if (min != -1000.0f || max != 1000.0f) {
+                    numErrors++;
+                }
+            }
+        }
+    }
+
+    CHECK(numErrors == 0);
+
+    // all NaN column leaves min and max untouched
+    float nans[MAX_N];
+    for (uint32_t i = 0; i < MAX_N; i++) {
+        nans[i] = NAN;
+    }
+    float min = INFINITY;
+    float max = -INFINITY;
+    reduceMinMax(nans, MAX_N, min, max);
+    CHECK(min == INFINITY && max == -INFINITY);
+
+    return TEST_RESULT();
+}
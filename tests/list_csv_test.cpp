@@ -0,0 +1,184 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <eez/util.h>
+#include <eez/modules/psu/list_csv.h>
+
+#include "test.h"
+
+using namespace eez;
+using namespace eez::psu::list;
+
+// parseFloat and parseListRow are checked on valid numbers and rows and on a corpus of
+// malformed list file rows, that must be rejected without reading past the end of the row.
+
+static bool isClose(float a, float b) {
+    return fabsf(a - b) <= 1E-6f * fmaxf(fabsf(a), fabsf(b));
+}
+
+// number is copied to the heap buffer of exactly its length, so reading past end is detected by the sanitizers
+static bool parseNumber(const char *str, float &result, size_t &numParsed) {
+    size_t length = strlen(str);
+    char *buffer = (char *)malloc(length + 1);
+    memcpy(buffer, str, length);
+    const char *p = buffer;
+    bool ok = parseFloat(p, buffer + length, result);
+    numParsed = p - buffer;
+    free(buffer);
+    return ok;
+}
+
+static bool parseRow(const char *row, float *values) {
+    size_t length = strlen(row);
+    char *buffer = (char *)malloc(length + 1);
+    memcpy(buffer, row, length);
+    bool ok = parseListRow(buffer, length, values);
+    free(buffer);
+    return ok;
+}
+
+static void checkFloat(const char *str, float expected, size_t expectedNumParsed) {
+    float result;
+    size_t numParsed;
+    bool ok = parseNumber(str, result, numParsed);
+    CHECK(ok);
+    if (ok) {
+        if (!isClose(result, expected) || numParsed != expectedNumParsed) {
+            printf("parseFloat(\"%s\") = %g (%d chars), expected %g (%d chars)\n", str, result, (int)numParsed, expected, (int)expectedNumParsed);
+            g_numFailedChecks++;
+        }
+    }
+}
+
+static void checkInvalidFloat(const char *str) {
+    float result;
+    size_t numParsed;
+    if (parseNumber(str, result, numParsed)) {
+        printf("parseFloat(\"%s\") should fail\n", str);
+        g_numFailedChecks++;
+    }
+}
+
+static const char *VALID_NUMBERS[] = {
+    "0", "1", "-1", "+1", "0.5", ".5", "5.", "-.5", "123.456", "1e3", "1E3", "1e+3", "1e-3",
+    "-2.5e-2", "0.001", "3.4e38", "1e-38", "12345678901234567890", "0.000000000012345",
+    "1.00000000000000000001", "99999999.9", "007", "1e0010"
+};
+
+static const char *INVALID_NUMBERS[] = {
+    "", "-", "+", ".", "-.", "e5", "E", "abc", "1e", "1e+", "1e-", "1ex", "1e999", "-1e999", "--1", "+-1"
+};
+
+struct Row {
+    const char *row;
+    bool valid;
+    float values[3];
+};
+
+static const Row ROWS[] = {
+    { "1,2,3", true, { 1, 2, 3 } },
+    { " 1 , 2 , 3 ", true, { 1, 2, 3 } },
+    { "\t0.5,\t10,\t1e-1\r", true, { 0.5f, 10, 0.1f } },
+    { "=,5,=", true, { NAN, 5, NAN } },
+    { " = , = , 0.25", true, { NAN, NAN, 0.25f } },
+    { "-0,+1.5,.5", true, { 0, 1.5f, 0.5f } },
+
+    { "", false },
+    { "1", false },
+    { "1,2", false },
+    { "1,2,", false },
+    { ",2,3", false },
+    { "1,,3", false },
+    { "1,2,3,", false },
+    { "1,2,3,4", false },
+    { "1;2;3", false },
+    { "1 2,3,4", false },
+    { "1,2,3x", false },
+    { "a,b,c", false },
+    { "1,2,==", false },
+    { "=1,2,3", false },
+    { "1,2,3e", false },
+    { "1,2,1e999", false },
+    { "1,2,3\n", false },
+    { ",,", false },
+    { " , , ", false },
+    { "\"1\",\"2\",\"3\"", false },
+};
+
+int main() {
+    for (size_t i = 0; i < sizeof(VALID_NUMBERS) / sizeof(VALID_NUMBERS[0]); i++) {
+        checkFloat(VALID_NUMBERS[i], strtof(VALID_NUMBERS[i], nullptr), strlen(VALID_NUMBERS[i]));
+    }
+
+    for (size_t i = 0; i < sizeof(INVALID_NUMBERS) / sizeof(INVALID_NUMBERS[0]); i++) {
+        checkInvalidFloat(INVALID_NUMBERS[i]);
+    }
+
+    // parsing stops at the first character that is not part of the number
+    checkFloat("1.5V", 1.5f, 3);
+    checkFloat("2,3", 2, 1);
+    checkFloat("1.2.3", 1.2f, 3);
+    checkFloat("-7 ", -7, 2);
+
+    // end is respected even if the number continues after it
+    {
+        const char *str = "12345";
+        const char *p = str;
+        float result;
+        CHECK(parseFloat(p, str + 2, result) && result == 12 && p == str + 2);
+    }
+
+    for (size_t i = 0; i < sizeof(ROWS) / sizeof(ROWS[0]); i++) {
+        float values[3];
+        bool ok = parseRow(ROWS[i].row, values);
+        if (ok != ROWS[i].valid) {
+            printf("parseListRow(\"%s\") = %s, expected %s\n", ROWS[i].row, ok ? "true" : "false", ROWS[i].valid ? "true" : "false");
+            g_numFailedChecks++;
+            continue;
+        }
+        if (ok) {
+            for (int j = 0; j < 3; j++) {
+                if (isnan(ROWS[i].values[j]) ? !isnan(values[j]) : !isClose(values[j], ROWS[i].values[j])) {
+                    printf("parseListRow(\"%s\") column %d = %g, expected %g\n", ROWS[i].row, j, values[j], ROWS[i].values[j]);
+                    g_numFailedChecks++;
+                }
+            }
+        }
+    }
+
+    // every prefix of a valid row is parsed within its length
+    {
+        const char *row = "0.01,12.5,-3.25";
+        size_t length = strlen(row);
+        for (size_t n = 0; n <= length; n++) {
+            char *buffer = (char *)malloc(n + 1);
+            memcpy(buffer, row, n);
+            float values[3];
+            bool ok = parseListRow(buffer, n, values);
+            free(buffer);
+            // last column must have at least one digit: "-3"
+            CHECK(ok == (n >= 12));
+        }
+    }
+
+    return TEST_RESULT();
+}
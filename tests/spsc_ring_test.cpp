@@ -0,0 +1,155 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <eez/spsc_ring.h>
+
+#include <thread>
+
+#include "test.h"
+
+using namespace eez;
+
+// Producer writes rows of ROW_SIZE items and publishes after a varying number of rows, consumer
+// takes a varying number of items. Row size is not a power of 2, so rows are split by the wrap
+// around. Every item is a function of its absolute index, so a lost, repeated or torn row is seen
+// as a wrong value or as a number of published items that is not a multiple of the row size.
+
+static const uint32_t CAPACITY = 256;
+static const uint32_t ROW_SIZE = 7;
+static const uint32_t NUM_ROWS = 2000000;
+
+static uint32_t itemValue(uint32_t index) {
+    return index * 2654435761u;
+}
+
+static uint32_t nextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 16;
+}
+
+static void testSingleThread() {
+    uint32_t buffer[8];
+    SpscRing<uint32_t> ring;
+    ring.init(buffer, 8);
+
+    uint32_t items[5] = { 1, 2, 3, 4, 5 };
+    CHECK(ring.getFreeSpace() == 8);
+    CHECK(ring.write(items, 5));
+    CHECK(ring.getAvailable() == 0); // not published yet
+    CHECK(ring.getNumUnpublished() == 5);
+
+    uint32_t fixed = 10;
+    ring.rewrite(1, &fixed, 1);
+    ring.publish();
+    CHECK(ring.getAvailable() == 5);
+    CHECK(!ring.write(items, 4)); // only 3 free
+
+    const uint32_t *p;
+    CHECK(ring.peek(p) == 5);
+    CHECK(p[0] == 1 && p[1] == 10 && p[4] == 5);
+    ring.commit(4);
+
+    // wraps around the end of the buffer
+    CHECK(ring.push(items, 5));
+    CHECK(ring.getAvailable() == 6);
+    CHECK(ring.peek(p) == 4); // contiguous part only
+    uint32_t out[6];
+    ring.copyOut(ring.getReadIndex(), out, 6);
+    CHECK(out[0] == 5 && out[1] == 1 && out[5] == 5);
+    ring.commit(6);
+    CHECK(ring.getAvailable() == 0);
+    CHECK(ring.getFreeSpace() == 8);
+
+    ring.reset();
+    CHECK(ring.getReadIndex() == 0 && ring.getWriteIndex() == 0);
+}
+
+static void testTwoThreads() {
+    static uint32_t buffer[CAPACITY];
+    SpscRing<uint32_t> ring;
+    ring.init(buffer, CAPACITY);
+
+    std::thread producer([&ring]() {
+        uint32_t random = 1;
+        uint32_t row[ROW_SIZE];
+        uint32_t index = 0;
+        uint32_t rowsUntilPublish = 1;
+        for (uint32_t rowIndex = 0; rowIndex < NUM_ROWS; rowIndex++) {
+            for (uint32_t i = 0; i < ROW_SIZE; i++) {
+                row[i] = itemValue(index + i);
+            }
+            while (!ring.write(row, ROW_SIZE)) {
+                // rows that don't fit must be published or consumer would never make space
+                ring.publish();
+                std::this_thread::yield();
+            }
+            index += ROW_SIZE;
+
+            if (--rowsUntilPublish == 0) {
+                ring.publish();
+                rowsUntilPublish = 1 + nextRandom(random) % 8;
+            }
+        }
+        ring.publish();
+    });
+
+    uint32_t random = 2;
+    uint32_t index = 0;
+    uint32_t numErrors = 0;
+    uint32_t numTornRows = 0;
+    while (index < NUM_ROWS * ROW_SIZE) {
+        uint32_t available = ring.getAvailable();
+        if (available == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // producer publishes only whole rows
+        if ((ring.getReadIndex() + available) % ROW_SIZE != 0) {
+            numTornRows++;
+        }
+
+        uint32_t n = 1 + nextRandom(random) % available;
+        while (n > 0) {
+            const uint32_t *items;
+            uint32_t contiguous = ring.peek(items);
+            uint32_t m = contiguous < n ? contiguous : n;
+            for (uint32_t i = 0; i < m; i++) {
+                if (items[i] != itemValue(index + i)) {
+                    numErrors++;
+                }
+            }
+            ring.commit(m);
+            index += m;
+            n -= m;
+        }
+    }
+
+    producer.join();
+
+    CHECK(numErrors == 0);
+    CHECK(numTornRows == 0);
+    CHECK(ring.getAvailable() == 0);
+    CHECK(ring.getReadIndex() == NUM_ROWS * ROW_SIZE);
+}
+
+int main() {
+    testSingleThread();
+    testTwoThreads();
+    return TEST_RESULT();
+}
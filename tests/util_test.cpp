@@ -0,0 +1,69 @@
+/*
+ * EEZ Modular Firmware
+ * Copyright (C) 2020-present, Envox d.o.o.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <eez/util.h>
+
+#include "test.h"
+
+using namespace eez;
+
+// crc32Update is checked against the known CRC-32 (IEEE 802.3) vectors, fed at once and in parts.
+
+struct Vector {
+    const char *data;
+    uint32_t crc;
+};
+
+static const Vector VECTORS[] = {
+    { "", 0x00000000 },
+    { "a", 0xE8B7BE43 },
+    { "abc", 0x352441C2 },
+    { "123456789", 0xCBF43926 },
+    { "message digest", 0x20159D7F },
+    { "abcdefghijklmnopqrstuvwxyz", 0x4C2750BD },
+    { "The quick brown fox jumps over the lazy dog", 0x414FA339 },
+};
+
+int main() {
+    for (size_t i = 0; i < sizeof(VECTORS) / sizeof(VECTORS[0]); i++) {
+        const uint8_t *data = (const uint8_t *)VECTORS[i].data;
+        size_t size = strlen(VECTORS[i].data);
+
+        CHECK(crc32Update(0, data, size) == VECTORS[i].crc);
+
+        // split at every position
+        for (size_t j = 0; j <= size; j++) {
+            uint32_t crc = crc32Update(0, data, j);
+            crc = crc32Update(crc, data + j, size - j);
+            CHECK(crc == VECTORS[i].crc);
+        }
+    }
+
+    // all byte values, zero padding changes the CRC
+    uint8_t buffer[256 + 4];
+    for (int i = 0; i < 256; i++) {
+        buffer[i] = (uint8_t)i;
+    }
+    memset(buffer + 256, 0, 4);
+    CHECK(crc32Update(0, buffer, 256) == 0x29058C73);
+    CHECK(crc32Update(0, buffer, 256 + 4) != crc32Update(0, buffer, 256));
+
+    return TEST_RESULT();
+}